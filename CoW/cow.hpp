@@ -2,20 +2,136 @@
 #define CoW_HPP
 
 #include "resource.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
+// Every version also carries a bitmap of the pages it has modified since the last checkpoint in
+// its history; a copy inherits its parent's bitmap along with its data. checkpoint() streams only
+// those pages, so its cost follows the change volume rather than the resource size, and a
+// version is restored by applying a full checkpoint and then each delta after it, in order.
+// Every record has an id and names the record it was taken after (its parent; none for a full
+// one), and a version remembers the last record in its history, so restore rejects a delta that
+// is applied to any other state: the wrong base, out of order, or from another branch.
+//
+// Checkpoint record: "CoWK", kind (0 full, 1 delta), then element count, page count, id and
+// parent id as uint64, then per page its uint64 index and its elements. Host byte order;
+// records are not portable.
 class CoWResource
 {
 private:
+  static const size_t kPageElements = 1024; // 4 KiB of int
+  static const uint32_t kFull = 0;
+  static const uint32_t kDelta = 1;
+
   std::shared_ptr<Resource> resource;
+  std::vector<uint64_t> dirty;
+  uint64_t last_checkpoint; // id of the last record in this version's history, 0 if none
+
+  // Unique within the process and, from the random start, across processes.
+  static uint64_t next_id()
+  {
+    static std::atomic<uint64_t> next((uint64_t(std::random_device()()) << 32) | 1);
+    uint64_t id = next.fetch_add(1);
+    return id != 0 ? id : next.fetch_add(1);
+  }
+
+  static size_t page_count(size_t elements)
+  {
+    return (elements + kPageElements - 1) / kPageElements;
+  }
+
+  void mark(size_t index)
+  {
+    size_t page = index / kPageElements;
+    if (page / 64 < dirty.size())
+    {
+      dirty[page / 64] |= uint64_t(1) << (page % 64);
+    }
+  }
+
+  bool is_dirty(size_t page) const
+  {
+    return (dirty[page / 64] >> (page % 64)) & 1;
+  }
+
+  void detach()
+  {
+    // Copy-on-write: if shared, create a copy
+    if (resource.use_count() > 1)
+    {
+      std::cout << "CoW: copying on write..." << std::endl;
+      resource = std::make_shared<Resource>(*resource);
+    }
+  }
+
+  template <typename T>
+  static void put(std::ostream& out, T value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  static T take(std::istream& in)
+  {
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    {
+      throw std::runtime_error("checkpoint truncated");
+    }
+    return value;
+  }
+
+  size_t write_pages(std::ostream& out, uint32_t kind, bool all, uint64_t id) const
+  {
+    size_t elements = resource->size();
+    size_t pages = page_count(elements);
+    uint64_t count = 0;
+    for (size_t page = 0; page < pages; ++page)
+    {
+      count += all || is_dirty(page);
+    }
+    out.write("CoWK", 4);
+    put<uint32_t>(out, kind);
+    put<uint64_t>(out, elements);
+    put<uint64_t>(out, count);
+    put<uint64_t>(out, id);
+    put<uint64_t>(out, kind == kFull ? 0 : last_checkpoint);
+    size_t written = 40;
+    for (size_t page = 0; page < pages; ++page)
+    {
+      if (!all && !is_dirty(page))
+      {
+        continue;
+      }
+      size_t first = page * kPageElements;
+      size_t length = std::min(size_t(kPageElements), elements - first) * sizeof(int);
+      put<uint64_t>(out, page);
+      out.write(reinterpret_cast<const char*>(resource->raw() + first), length);
+      written += sizeof(uint64_t) + length;
+    }
+    if (!out)
+    {
+      throw std::runtime_error("checkpoint write failed");
+    }
+    return written;
+  }
 
 public:
-  CoWResource() : resource(std::make_shared<Resource>())
+  CoWResource()
+      : resource(std::make_shared<Resource>()), dirty((page_count(resource->size()) + 63) / 64),
+        last_checkpoint(0)
   {
   }
 
-  CoWResource(const CoWResource& other) : resource(other.resource)
+  CoWResource(const CoWResource& other)
+      : resource(other.resource), dirty(other.dirty), last_checkpoint(other.last_checkpoint)
   {
     std::cout << "CoW copy: sharing resource." << std::endl;
   }
@@ -25,6 +141,8 @@ public:
     if (this != &other)
     {
       resource = other.resource;
+      dirty = other.dirty;
+      last_checkpoint = other.last_checkpoint;
       std::cout << "CoW assignment: sharing resource." << std::endl;
     }
     return *this;
@@ -32,13 +150,86 @@ public:
 
   void modify(size_t index, int value)
   {
-    // Copy-on-write: if shared, create a copy
-    if (resource.use_count() > 1)
+    detach();
+    resource->modify(index, value);
+    mark(index);
+  }
+
+  // Writes every page and starts a new delta chain from here. Returns the bytes written.
+  size_t checkpoint_full(std::ostream& out)
+  {
+    uint64_t id = next_id();
+    size_t written = write_pages(out, kFull, true, id);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    last_checkpoint = id;
+    return written;
+  }
+
+  // Writes the pages modified since the last checkpoint of this version or its ancestors. Throws
+  // std::logic_error if there is none, since the delta would have no base.
+  size_t checkpoint(std::ostream& out)
+  {
+    if (last_checkpoint == 0)
     {
-      std::cout << "CoW: copying on write..." << std::endl;
-      resource = std::make_shared<Resource>(*resource);
+      throw std::logic_error("delta checkpoint needs a full checkpoint first");
     }
-    resource->modify(index, value);
+    uint64_t id = next_id();
+    size_t written = write_pages(out, kDelta, false, id);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    last_checkpoint = id;
+    return written;
+  }
+
+  // Applies one checkpoint record from `in`: a full one replaces the contents, a delta must
+  // follow the record it was taken after. Throws std::runtime_error on a malformed record, and
+  // without touching this version on a delta whose parent is not the last record applied here.
+  void restore(std::istream& in)
+  {
+    char magic[4];
+    if (!in.read(magic, 4) || std::memcmp(magic, "CoWK", 4) != 0)
+    {
+      throw std::runtime_error("not a CoW checkpoint");
+    }
+    uint32_t kind = take<uint32_t>(in);
+    uint64_t elements = take<uint64_t>(in);
+    uint64_t count = take<uint64_t>(in);
+    uint64_t id = take<uint64_t>(in);
+    uint64_t parent = take<uint64_t>(in);
+    if (kind > kDelta || elements != resource->size() || count > page_count(elements))
+    {
+      throw std::runtime_error("checkpoint does not match this resource");
+    }
+    if (kind == kDelta && (parent == 0 || parent != last_checkpoint))
+    {
+      throw std::runtime_error("delta checkpoint does not follow this version's last record");
+    }
+    detach();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+      uint64_t page = take<uint64_t>(in);
+      if (page >= page_count(elements))
+      {
+        throw std::runtime_error("checkpoint page out of range");
+      }
+      size_t first = page * kPageElements;
+      size_t length = std::min(size_t(kPageElements), size_t(elements - first)) * sizeof(int);
+      if (!in.read(reinterpret_cast<char*>(resource->raw() + first), length))
+      {
+        throw std::runtime_error("checkpoint truncated");
+      }
+    }
+    std::fill(dirty.begin(), dirty.end(), 0);
+    last_checkpoint = id;
+  }
+
+  size_t dirty_pages() const
+  {
+    size_t pages = 0;
+    for (uint64_t word : dirty)
+    {
+      pages += __builtin_popcountll(word);
+    }
+    return pages;
   }
 
   int get(size_t index) const
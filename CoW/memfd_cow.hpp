@@ -0,0 +1,162 @@
+#ifndef MEMFD_CoW_HPP
+#define MEMFD_CoW_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+// Copy-on-write done by the kernel. The elements live once in a memfd, and every version is a
+// MAP_PRIVATE mapping of it: a copy is one mmap, reads share the memfd's pages, and the first
+// write to a page gives that version its own copy of just that page.
+//
+// A private mapping only sees the memfd, not another version's private pages, so each version
+// tracks the pages it has written. Copying a version that has diverged re-applies those pages
+// to the new mapping, which costs in proportion to the divergence; copying a clean one is O(1).
+// Linux only.
+class MemfdCoWResource
+{
+private:
+  static const size_t SIZE = 1000000; // 1 million elements, as Resource
+
+  struct Backing
+  {
+    int fd;
+    size_t bytes;
+
+    ~Backing()
+    {
+      ::close(fd);
+    }
+  };
+
+  std::shared_ptr<Backing> backing;
+  int* data;
+  size_t page_elements;
+  std::vector<uint64_t> dirty; // pages this version has written
+
+  static void fail(const char* what)
+  {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  void map_private()
+  {
+    void* mapping = ::mmap(nullptr, backing->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                           backing->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      fail("mmap");
+    }
+    data = static_cast<int*>(mapping);
+  }
+
+  // Gives this version the other's private pages.
+  void copy_dirty_from(const MemfdCoWResource& other)
+  {
+    for (size_t word = 0; word < dirty.size(); ++word)
+    {
+      for (uint64_t bits = dirty[word]; bits != 0; bits &= bits - 1)
+      {
+        size_t first = (word * 64 + __builtin_ctzll(bits)) * page_elements;
+        size_t count = std::min(page_elements, SIZE - first);
+        std::memcpy(data + first, other.data + first, count * sizeof(int));
+      }
+    }
+  }
+
+public:
+  MemfdCoWResource() : data(nullptr), page_elements(::sysconf(_SC_PAGESIZE) / sizeof(int))
+  {
+    int fd = ::memfd_create("cow-resource", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+      fail("memfd_create");
+    }
+    backing = std::shared_ptr<Backing>(new Backing{fd, SIZE * sizeof(int)});
+    if (::ftruncate(fd, backing->bytes) != 0)
+    {
+      fail("ftruncate");
+    }
+    // Fill through a shared mapping so the values land in the memfd itself.
+    void* shared = ::mmap(nullptr, backing->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shared == MAP_FAILED)
+    {
+      fail("mmap");
+    }
+    int* values = static_cast<int*>(shared);
+    for (size_t i = 0; i < SIZE; ++i)
+    {
+      values[i] = i;
+    }
+    ::munmap(shared, backing->bytes);
+    dirty.assign(((SIZE + page_elements - 1) / page_elements + 63) / 64, 0);
+    map_private();
+  }
+
+  MemfdCoWResource(const MemfdCoWResource& other)
+      : backing(other.backing), data(nullptr), page_elements(other.page_elements),
+        dirty(other.dirty)
+  {
+    map_private();
+    copy_dirty_from(other);
+  }
+
+  MemfdCoWResource& operator=(const MemfdCoWResource& other)
+  {
+    if (this != &other)
+    {
+      MemfdCoWResource copy(other);
+      std::swap(backing, copy.backing);
+      std::swap(data, copy.data);
+      std::swap(dirty, copy.dirty);
+    }
+    return *this;
+  }
+
+  ~MemfdCoWResource()
+  {
+    if (data)
+    {
+      ::munmap(data, backing->bytes);
+    }
+  }
+
+  void modify(size_t index, int value)
+  {
+    if (index < SIZE)
+    {
+      data[index] = value;
+      size_t page = index / page_elements;
+      dirty[page / 64] |= uint64_t(1) << (page % 64);
+    }
+  }
+
+  int get(size_t index) const
+  {
+    return index < SIZE ? data[index] : -1;
+  }
+
+  size_t size() const
+  {
+    return SIZE;
+  }
+
+  // Pages this version holds privately.
+  size_t private_pages() const
+  {
+    size_t pages = 0;
+    for (uint64_t word : dirty)
+    {
+      pages += __builtin_popcountll(word);
+    }
+    return pages;
+  }
+};
+
+#endif
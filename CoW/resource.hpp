@@ -69,6 +69,17 @@ public:
   {
     return data.size();
   }
+
+  // Direct access for bulk I/O such as checkpoints; no bounds checks.
+  const int* raw() const
+  {
+    return data.data();
+  }
+
+  int* raw()
+  {
+    return data.data();
+  }
 };
 
 #endif
\ No newline at end of file
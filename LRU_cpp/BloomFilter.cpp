@@ -0,0 +1,62 @@
+#include "BloomFilter.hpp"
+
+#include <algorithm>
+
+uint64_t BloomFilter::_hash(int key)
+{
+  // splitmix64 finaliser: consecutive keys must not land in neighbouring blocks and bits.
+  uint64_t h = static_cast<uint32_t>(key);
+  h += 0x9e3779b97f4a7c15ull;
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+  return h ^ (h >> 31);
+}
+
+BloomFilter::BloomFilter(size_t capacity, size_t bits_per_key)
+    : limit(std::max<size_t>(capacity, 1))
+{
+  size_t block_count = 1;
+  while (block_count * kBlockWords * 64 < limit * std::max<size_t>(bits_per_key, 1))
+  {
+    block_count *= 2;
+  }
+  blocks.assign(block_count, Block{});
+  block_mask = block_count - 1;
+}
+
+// Each probe takes its own 9 bits from the low 54 of the hash; the block comes from a second
+// multiplicative mix so the block count is not limited by the 10 bits left over.
+size_t BloomFilter::_block(uint64_t h) const
+{
+  return static_cast<size_t>(((h * 0x9e3779b97f4a7c15ull) >> 32) & block_mask);
+}
+
+void BloomFilter::add(int key)
+{
+  uint64_t h = _hash(key);
+  uint64_t* block = blocks[_block(h)].words;
+  bool added = false;
+  for (int probe = 0; probe < kProbes; ++probe)
+  {
+    uint64_t bit = (h >> (probe * 9)) & 511;
+    uint64_t mask = uint64_t{1} << (bit & 63);
+    added |= !(block[bit >> 6] & mask);
+    block[bit >> 6] |= mask;
+  }
+  count += added;
+}
+
+bool BloomFilter::may_contain(int key) const
+{
+  uint64_t h = _hash(key);
+  const uint64_t* block = blocks[_block(h)].words;
+  for (int probe = 0; probe < kProbes; ++probe)
+  {
+    uint64_t bit = (h >> (probe * 9)) & 511;
+    if (!(block[bit >> 6] & (uint64_t{1} << (bit & 63))))
+    {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Blocked Bloom filter over int keys: all of a key's probe bits fall in one 64-byte block, and
+// blocks are 64-byte aligned, so a lookup touches a single cache line. Sized for `capacity` keys
+// at `bits_per_key`; past that the false-positive rate climbs, and the owner is expected to
+// rebuild a larger one.
+class BloomFilter
+{
+private:
+  static constexpr size_t kBlockWords = 8; // 512 bits
+  static constexpr int kProbes = 6;
+
+  struct alignas(64) Block
+  {
+    uint64_t words[kBlockWords];
+  };
+
+  std::vector<Block> blocks;
+  size_t block_mask;
+  size_t limit;
+  size_t count = 0;
+
+  static uint64_t _hash(int key);
+  size_t _block(uint64_t h) const;
+
+public:
+  explicit BloomFilter(size_t capacity, size_t bits_per_key = 10);
+
+  // Adding a key whose bits are all set already, such as a repeat, does not count toward size.
+  void add(int key);
+  bool may_contain(int key) const;
+
+  size_t size() const
+  {
+    return count;
+  }
+  size_t capacity() const
+  {
+    return limit;
+  }
+  size_t footprint() const
+  {
+    return blocks.size() * sizeof(Block);
+  }
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "Compress.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t kMinMatch = 4;
+constexpr size_t kHashBits = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr size_t kLastLiterals = 5;  // the block ends in at least this many literals
+constexpr size_t kMatchSafety = 12;  // no match starts in the last 12 bytes
+constexpr size_t kCopySlack = 8;     // a wild copy may write this far past its end
+
+// The match finder's table, kept per thread across calls so that compressing a small value
+// neither allocates nor clears 16 KiB. A slot holds `base + position`, and each call starts
+// `base` past every position an earlier call stored, so stale slots read as out of range.
+struct HashTable
+{
+  uint32_t slots[size_t{1} << kHashBits] = {};
+  uint32_t base = 1;
+};
+
+uint32_t read32(const char* p)
+{
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint64_t read64(const char* p)
+{
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Copies count bytes in 8-byte words, reading and writing up to kCopySlack - 1 bytes past both
+// ends. Source and destination must be at least 8 bytes apart if they overlap, so each word is
+// complete before it is read back.
+void wild_copy(char* dst, const char* src, size_t count)
+{
+  for (size_t i = 0; i < count; i += 8)
+  {
+    std::memcpy(dst + i, src + i, 8);
+  }
+}
+
+// Bytes from a and b that agree, up to limit, compared eight at a time.
+size_t common_length(const char* a, const char* b, size_t limit)
+{
+  size_t length = 0;
+  while (length + 8 <= limit)
+  {
+    uint64_t diff = read64(a + length) ^ read64(b + length);
+    if (diff != 0)
+    {
+      return length + __builtin_ctzll(diff) / 8;
+    }
+    length += 8;
+  }
+  while (length < limit && a[length] == b[length])
+  {
+    ++length;
+  }
+  return length;
+}
+
+char* put_length(char* out, size_t length)
+{
+  while (length >= 255)
+  {
+    *out++ = static_cast<char>(255);
+    length -= 255;
+  }
+  *out++ = static_cast<char>(length);
+  return out;
+}
+
+char* put_literals(char* out, uint8_t match_code, const char* literals, size_t literal_count)
+{
+  *out++ = static_cast<char>((std::min<size_t>(literal_count, 15) << 4) | match_code);
+  if (literal_count >= 15)
+  {
+    out = put_length(out, literal_count - 15);
+  }
+  std::memcpy(out, literals, literal_count);
+  return out + literal_count;
+}
+
+char* put_sequence(char* out, const char* literals, size_t literal_count, size_t offset,
+                   size_t match_length)
+{
+  size_t match_code = match_length - kMinMatch;
+  out = put_literals(out, static_cast<uint8_t>(std::min<size_t>(match_code, 15)), literals,
+                     literal_count);
+  *out++ = static_cast<char>(offset & 0xff);
+  *out++ = static_cast<char>(offset >> 8);
+  if (match_code >= 15)
+  {
+    out = put_length(out, match_code - 15);
+  }
+  return out;
+}
+
+size_t get_length(std::string_view block, size_t& pos, size_t length)
+{
+  if (length != 15)
+  {
+    return length;
+  }
+  uint8_t byte;
+  do
+  {
+    if (pos >= block.size())
+    {
+      throw std::runtime_error("lz block truncated in a length");
+    }
+    byte = static_cast<uint8_t>(block[pos++]);
+    length += byte;
+  } while (byte == 255);
+  return length;
+}
+} // namespace
+
+std::string lz_compress(std::string_view input)
+{
+  thread_local HashTable hash;
+  const char* src = input.data();
+  const size_t size = input.size();
+  // Literals cost one length byte per 255 beyond the token, and a match never takes more bytes
+  // than it covers, so this bounds the block.
+  std::string out(size + size / 255 + 16, '\0');
+  char* dst = &out[0];
+
+  size_t anchor = 0;
+  if (size > kMatchSafety)
+  {
+    if (size > UINT32_MAX - hash.base)
+    {
+      std::fill(std::begin(hash.slots), std::end(hash.slots), 0);
+      hash.base = 1;
+    }
+    const uint32_t base = hash.base;
+    hash.base += static_cast<uint32_t>(size);
+    size_t limit = size - kMatchSafety;
+    size_t pos = 0;
+    while (pos < limit)
+    {
+      uint32_t sequence = read32(src + pos);
+      uint32_t& slot = hash.slots[(sequence * 2654435761u) >> (32 - kHashBits)];
+      uint32_t stored = slot;
+      slot = base + static_cast<uint32_t>(pos);
+      if (stored < base || pos - (stored - base) > kMaxOffset ||
+          read32(src + (stored - base)) != sequence)
+      {
+        ++pos;
+        continue;
+      }
+
+      size_t ref = stored - base;
+      size_t length = kMinMatch + common_length(src + ref + kMinMatch, src + pos + kMinMatch,
+                                                size - kLastLiterals - pos - kMinMatch);
+      dst = put_sequence(dst, src + anchor, pos - anchor, pos - ref, length);
+      pos += length;
+      anchor = pos;
+    }
+  }
+
+  dst = put_literals(dst, 0, src + anchor, size - anchor);
+  out.resize(dst - out.data());
+  return out;
+}
+
+std::string lz_decompress(std::string_view block, size_t original_size)
+{
+  // Decodes into a per-thread scratch buffer with slack past the end, so literals and matches
+  // can be copied eight bytes at a time and overshoot; the result is one copy out of it, and
+  // nothing is zero-filled.
+  thread_local std::string scratch;
+  if (scratch.size() < original_size + kCopySlack)
+  {
+    scratch.resize(original_size + kCopySlack);
+  }
+  char* const out = &scratch[0];
+  size_t written = 0;
+  size_t pos = 0;
+  while (pos < block.size())
+  {
+    uint8_t token = static_cast<uint8_t>(block[pos++]);
+    size_t literal_count = get_length(block, pos, token >> 4);
+    if (literal_count > block.size() - pos || literal_count > original_size - written)
+    {
+      throw std::runtime_error("lz block literals overrun");
+    }
+    if (block.size() - pos >= literal_count + kCopySlack)
+    {
+      wild_copy(out + written, block.data() + pos, literal_count);
+    }
+    else
+    {
+      std::memcpy(out + written, block.data() + pos, literal_count);
+    }
+    written += literal_count;
+    pos += literal_count;
+    if (pos == block.size())
+    {
+      break;
+    }
+
+    if (block.size() - pos < 2)
+    {
+      throw std::runtime_error("lz block truncated in an offset");
+    }
+    size_t offset = static_cast<uint8_t>(block[pos]) | static_cast<uint8_t>(block[pos + 1]) << 8;
+    pos += 2;
+    size_t length = get_length(block, pos, token & 15) + kMinMatch;
+    if (offset == 0 || offset > written || length > original_size - written)
+    {
+      throw std::runtime_error("lz block match out of range");
+    }
+    if (offset >= 8)
+    {
+      wild_copy(out + written, out + written - offset, length);
+      written += length;
+      continue;
+    }
+    // Byte by byte: a match this close repeats the bytes it is producing.
+    for (size_t i = 0; i < length; ++i, ++written)
+    {
+      out[written] = out[written - offset];
+    }
+  }
+  if (written != original_size)
+  {
+    throw std::runtime_error("lz block decoded to the wrong size");
+  }
+  return std::string(out, written);
+}
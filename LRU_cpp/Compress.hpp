@@ -0,0 +1,20 @@
+#ifndef COMPRESS_HPP
+#define COMPRESS_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// In-tree LZ77 block codec with the LZ4 block layout: each sequence is a token (literal count in
+// the high nibble, match length - 4 in the low one, 15 meaning "more bytes follow"), the
+// literals, then a 2-byte little-endian offset back into the output. The last sequence is
+// literals only. The original size is not stored.
+//
+// Compression is greedy with one 4096-slot hash of 4-byte prefixes, kept per thread so small
+// values pay neither an allocation nor a clear; decompression copies eight bytes at a time.
+std::string lz_compress(std::string_view input);
+
+// Throws std::runtime_error if `block` does not decode to exactly `original_size` bytes.
+std::string lz_decompress(std::string_view block, size_t original_size);
+
+#endif
@@ -0,0 +1,107 @@
+#include "CompressedTier.hpp"
+#include "Compress.hpp"
+
+#include <climits>
+
+namespace
+{
+constexpr uint32_t kMaxOfferedBits = 20;
+} // namespace
+
+CompressedTier::CompressedTier(size_t budget_bytes)
+    : budget(budget_bytes), offered(size_t{1} << offered_bits, INT_MIN)
+{
+}
+
+void CompressedTier::_erase(std::unordered_map<int, Entry>::iterator it)
+{
+  used -= it->second.data.size();
+  raw -= it->second.original_size;
+  order.erase(it->second.order);
+  entries.erase(it);
+}
+
+int& CompressedTier::_offered_slot(int idx)
+{
+  return offered[(static_cast<uint32_t>(idx) * 2654435761u) >> (32 - offered_bits)];
+}
+
+bool CompressedTier::_admit(int idx, size_t size)
+{
+  ++offer_count;
+  offered_bytes += size;
+  while (offered_bits < kMaxOfferedBits &&
+         (size_t{1} << offered_bits) * offered_bytes < 4 * budget * offer_count)
+  {
+    ++offered_bits;
+  }
+  if (offered.size() != size_t{1} << offered_bits)
+  {
+    // Rehash rather than clear, so growing the window does not forget the keys it holds.
+    std::vector<int> old(size_t{1} << offered_bits, INT_MIN);
+    old.swap(offered);
+    for (int key : old)
+    {
+      if (key != INT_MIN)
+      {
+        _offered_slot(key) = key;
+      }
+    }
+  }
+  int& slot = _offered_slot(idx);
+  if (slot == idx)
+  {
+    return true;
+  }
+  slot = idx;
+  ++rejection_count;
+  return false;
+}
+
+void CompressedTier::put(int idx, const std::string& value)
+{
+  remove(idx);
+  if (!_admit(idx, value.size()))
+  {
+    return;
+  }
+  std::string data = lz_compress(value);
+  if (data.size() > budget)
+  {
+    return;
+  }
+  while (used + data.size() > budget)
+  {
+    _erase(entries.find(order.back()));
+    ++eviction_count;
+  }
+  used += data.size();
+  raw += value.size();
+  order.push_front(idx);
+  entries.emplace(idx, Entry{std::move(data), static_cast<uint32_t>(value.size()), order.begin()});
+}
+
+auto CompressedTier::take(int idx) -> std::optional<std::string>
+{
+  auto it = entries.find(idx);
+  if (it == entries.end())
+  {
+    ++miss_count;
+    return std::nullopt;
+  }
+  ++hit_count;
+  std::string value = lz_decompress(it->second.data, it->second.original_size);
+  _erase(it);
+  return value;
+}
+
+bool CompressedTier::remove(int idx)
+{
+  auto it = entries.find(idx);
+  if (it == entries.end())
+  {
+    return false;
+  }
+  _erase(it);
+  return true;
+}
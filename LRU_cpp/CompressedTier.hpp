@@ -0,0 +1,92 @@
+#ifndef COMPRESSED_TIER_HPP
+#define COMPRESSED_TIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Victim cache behind LRU: values evicted from tier 1 are kept here lz-compressed, within a byte
+// budget of compressed data, and leave again either by promotion on a tier-1 miss or by falling
+// off this tier's own LRU order.
+//
+// Most evictions are of keys that are not asked for again before they would fall off, and
+// compressing those is wasted work. So a value is only compressed if its key was evicted before
+// and is still remembered: a direct-mapped table keeps the last key offered per slot, with four
+// slots per value the budget would hold uncompressed (at the average size offered so far), so it
+// spans a window of evictions comparable to how long this tier itself keeps an entry.
+class CompressedTier
+{
+private:
+  struct Entry
+  {
+    std::string data;
+    uint32_t original_size;
+    std::list<int>::iterator order;
+  };
+
+  size_t budget;
+  size_t used = 0;
+  size_t raw = 0;
+  std::list<int> order; // most recent first
+  std::unordered_map<int, Entry> entries;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+  size_t eviction_count = 0;
+  size_t rejection_count = 0;
+  size_t offer_count = 0;
+  size_t offered_bytes = 0;
+  uint32_t offered_bits = 6;
+  std::vector<int> offered; // keys evicted once, by hash slot
+
+  int& _offered_slot(int idx);
+  bool _admit(int idx, size_t size);
+
+  void _erase(std::unordered_map<int, Entry>::iterator it);
+
+public:
+  explicit CompressedTier(size_t budget_bytes);
+
+  // If idx is remembered from an earlier offer, compresses and keeps value, evicting the oldest
+  // entries to stay within budget; otherwise only remembers idx. A value that does not fit even
+  // alone is dropped.
+  void put(int idx, const std::string& value);
+  // Decompresses and removes idx, for promotion back into tier 1.
+  std::optional<std::string> take(int idx);
+  bool remove(int idx);
+
+  size_t size() const
+  {
+    return entries.size();
+  }
+  size_t compressed_bytes() const
+  {
+    return used;
+  }
+  size_t raw_bytes() const
+  {
+    return raw;
+  }
+  size_t hits() const
+  {
+    return hit_count;
+  }
+  size_t misses() const
+  {
+    return miss_count;
+  }
+  size_t evictions() const
+  {
+    return eviction_count;
+  }
+  // Values not admitted because their key had not been offered recently.
+  size_t rejections() const
+  {
+    return rejection_count;
+  }
+};
+
+#endif
@@ -20,12 +20,26 @@ std::optional<std::string> LRU::getitem(int idx)
   auto iter = itemMap.find(idx);
   if (iter == itemMap.end())
   {
-    return std::nullopt;
+    if (!tier2)
+    {
+      return std::nullopt;
+    }
+    auto promoted = tier2->take(idx);
+    if (promoted)
+    {
+      insert(idx, std::string(*promoted));
+    }
+    return promoted;
   }
   _put_first(idx);
   return *iter->second;
 }
 
+bool LRU::contains(int idx) const
+{
+  return itemMap.count(idx) != 0;
+}
+
 void LRU::dumplist()
 {
   if (itemMap.size() == 0)
@@ -55,12 +69,24 @@ LRU::LRU() : capacity(kDefaultCapacity)
 {
 }
 
+LRU::LRU(size_t capacity) : capacity(capacity)
+{
+}
+
+LRU::LRU(size_t capacity, size_t tier2_bytes)
+    : capacity(capacity),
+      tier2(tier2_bytes ? std::make_unique<CompressedTier>(tier2_bytes) : nullptr)
+{
+}
+
 bool LRU::remove(int idx)
 {
+  // A key lives in at most one tier, but a demoted one must go too or getitem would promote it.
+  bool removed = tier2 && tier2->remove(idx);
   auto map_it = itemMap.find(idx);
   if (map_it == itemMap.end())
   {
-    return false;
+    return removed;
   }
   auto list_it = map_it->second;
   itemMap.erase(map_it);
@@ -99,6 +125,10 @@ void LRU::_remove_last()
   if (key_to_remove != -1)
   {
     itemMap.erase(key_to_remove);
+    if (tier2)
+    {
+      tier2->put(key_to_remove, *last_it);
+    }
   }
   itemList.pop_back();
 }
\ No newline at end of file
@@ -3,31 +3,45 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 
+#include "CompressedTier.hpp"
+
 class LRU
 {
 private:
   size_t capacity;
   std::list<std::string> itemList;
   std::map<int, std::list<std::string>::iterator> itemMap;
+  std::unique_ptr<CompressedTier> tier2; // evicted values, compressed; null when disabled
 
   void _put_first(int idx); // need valid id
   void _remove_last();
 
 public:
   LRU();
+  explicit LRU(size_t capacity);
+  // With a non-zero budget, evicted values move to a compressed second tier of that many bytes
+  // and a miss here is promoted back from it.
+  LRU(size_t capacity, size_t tier2_bytes);
   ~LRU() = default;
 
   //
 
   std::optional<std::string> getitem(int idx);
+  bool contains(int idx) const; // no recency update
   void dumplist();
 
   bool remove(int idx);
 
   bool insert(int idx, std::string&& str);
+
+  const CompressedTier* second_tier() const
+  {
+    return tier2.get();
+  }
 };
 
 
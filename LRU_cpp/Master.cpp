@@ -1,56 +1,337 @@
 #include "Master.hpp"
 
-auto Memory::getitem(int idx) -> rettype
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+auto Memory::getitem(int idx) const -> rettype
 {
-  for (auto& item : mem)
+  auto it = std::find(keys.begin(), keys.end(), idx);
+  if (it == keys.end())
   {
-    if (item.first == idx)
+    return std::nullopt;
+  }
+  return _entry(static_cast<size_t>(it - keys.begin()));
+}
+
+auto Memory::getitem(std::string_view str) const -> rettype
+{
+  for (size_t pos = 0; pos < keys.size(); ++pos)
+  {
+    if (lengths[pos] == str.size() &&
+        std::memcmp(arena.data() + offsets[pos], str.data(), str.size()) == 0)
     {
-      return item;
+      return _entry(pos);
     }
   }
   return std::nullopt;
 }
 
-auto Memory::getitem(const std::string& str) -> rettype
+auto Memory::getitems(const std::vector<int>& wanted) const -> std::vector<rettype>
 {
-  for (auto& item : mem)
+  std::vector<rettype> found(wanted.size());
+  size_t missing = wanted.size();
+  if (wanted.empty())
+  {
+    return found;
+  }
+  // Prefetch batches are narrow key ranges, so most entries fail the bounds test alone.
+  auto [low, high] = std::minmax_element(wanted.begin(), wanted.end());
+  for (size_t pos = 0; pos < keys.size() && missing > 0; ++pos)
   {
-    if (item.second == str)
+    if (keys[pos] < *low || keys[pos] > *high)
+    {
+      continue;
+    }
+    for (size_t i = 0; i < wanted.size(); ++i)
     {
-      return item;
+      if (!found[i] && wanted[i] == keys[pos])
+      {
+        found[i] = _entry(pos);
+        --missing;
+      }
     }
   }
-  return std::nullopt;
+  return found;
+}
+
+void Memory::insert(int idx, std::string_view value)
+{
+  if (arena.size() + value.size() > std::numeric_limits<uint32_t>::max())
+  {
+    throw std::length_error("Memory arena is limited to 4 GiB");
+  }
+  keys.push_back(idx);
+  offsets.push_back(static_cast<uint32_t>(arena.size()));
+  lengths.push_back(static_cast<uint32_t>(value.size()));
+  arena.insert(arena.end(), value.begin(), value.end());
+}
+
+bool Memory::replace(int idx, std::string_view value)
+{
+  auto it = std::find(keys.begin(), keys.end(), idx);
+  if (it == keys.end())
+  {
+    return false;
+  }
+  size_t pos = static_cast<size_t>(it - keys.begin());
+  if (value.size() <= lengths[pos])
+  {
+    std::memcpy(arena.data() + offsets[pos], value.data(), value.size());
+  }
+  else
+  {
+    if (arena.size() + value.size() > std::numeric_limits<uint32_t>::max())
+    {
+      throw std::length_error("Memory arena is limited to 4 GiB");
+    }
+    offsets[pos] = static_cast<uint32_t>(arena.size());
+    arena.insert(arena.end(), value.begin(), value.end());
+  }
+  lengths[pos] = static_cast<uint32_t>(value.size());
+  return true;
+}
+
+void Memory::reserve(size_t entries, size_t bytes)
+{
+  keys.reserve(entries);
+  offsets.reserve(entries);
+  lengths.reserve(entries);
+  arena.reserve(bytes);
+}
+
+namespace
+{
+constexpr size_t kInitialFilterKeys = 1024;
+}
+
+Master::Master(PrefetchConfig prefetch, NegativeConfig negative)
+    : negative(negative),
+      filter(negative.enabled ? kInitialFilterKeys : 1, negative.bits_per_key),
+      absent(negative.enabled ? std::max<size_t>(negative.entries, 1) : 0),
+      prefetch(prefetch)
+{
+  if (prefetch.background)
+  {
+    worker = std::thread([this] { _worker_loop(); });
+  }
 }
 
-void Memory::insert(std::pair<int, std::string> dat)
+Master::~Master()
 {
-  mem.push_back(std::move(dat));
+  if (worker.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> guard(queue_lock);
+      stopping = true;
+    }
+    queue_cv.notify_one();
+    worker.join();
+  }
 }
 
 void Master::store(int idx, std::string value)
 {
-  mem.insert({idx, std::move(value)});
+  std::lock_guard<std::mutex> guard(lock);
+  bool added = !mem.replace(idx, value);
+  if (added)
+  {
+    mem.insert(idx, value);
+  }
+  // The next fetch reads the new value from Memory, and only then may NearCaches refill.
+  cache.remove(idx);
+  prefetched.erase(idx);
+  versions[static_cast<uint32_t>(idx) % kVersionStripes].fetch_add(1, std::memory_order_release);
+  // A replaced key is already in the filter and cannot be in the absent table.
+  if (!negative.enabled || !added)
+  {
+    return;
+  }
+  if (filter.size() == filter.capacity())
+  {
+    filter = BloomFilter(filter.capacity() * 2, negative.bits_per_key);
+    for (size_t pos = 0; pos + 1 < mem.size(); ++pos)
+    {
+      filter.add(mem.key_at(pos));
+    }
+  }
+  filter.add(idx);
+  NegativeSlot& slot = _absent_slot(idx);
+  if (slot.valid && slot.key == idx)
+  {
+    slot.valid = false;
+  }
+}
+
+auto Master::_absent_slot(int idx) -> NegativeSlot&
+{
+  return absent[(static_cast<uint32_t>(idx) * 2654435769u) % absent.size()];
 }
 
 auto Master::fetch(int idx) -> str
 {
-  if (auto cached = cache.getitem(idx))
+  str result;
+  std::vector<int> ahead;
   {
-    return cached;
+    std::lock_guard<std::mutex> guard(lock);
+    if (negative.enabled && !filter.may_contain(idx))
+    {
+      ++negative_counters.filtered;
+      return result;
+    }
+    if (negative.enabled && _absent_slot(idx).valid && _absent_slot(idx).key == idx)
+    {
+      ++negative_counters.negative_hits;
+      return result;
+    }
+    if (auto cached = cache.getitem(idx))
+    {
+      ++counters.hits;
+      counters.useful += prefetched.erase(idx);
+      result = std::move(cached);
+    }
+    else
+    {
+      ++counters.misses;
+      prefetched.erase(idx); // prefetched, then evicted unused
+      if (auto stored = mem.getitem(idx))
+      {
+        std::string value(stored->second);
+        cache.insert(idx, std::string(value));
+        result = std::move(value);
+      }
+      else if (negative.enabled)
+      {
+        ++negative_counters.false_positives;
+        _absent_slot(idx) = {idx, true};
+      }
+    }
+
+    ahead = _detect(idx);
+    if (!ahead.empty() && !prefetch.background)
+    {
+      _prefetch(ahead);
+      return result;
+    }
   }
 
-  if (auto stored = mem.getitem(idx))
+  if (!ahead.empty())
   {
-    cache.insert(idx, std::string(stored->second));
-    return stored->second;
+    {
+      std::lock_guard<std::mutex> guard(queue_lock);
+      queue.push_back(std::move(ahead));
+    }
+    queue_cv.notify_one();
   }
+  return result;
+}
 
-  return std::nullopt;
+// Feeds one demand key to the stride detector and returns the keys to prefetch, if any. A
+// confirmed stream is kept between degree / 2 and 3 * degree / 2 strides ahead of the demand
+// key, topped up `degree` keys at a time so each Memory pass covers a whole batch.
+std::vector<int> Master::_detect(int idx)
+{
+  int64_t stride = static_cast<int64_t>(idx) - last_key;
+  bool continues = seen_any && stride != 0 && stride == last_stride;
+  run = continues ? run + 1 : 1;
+  if (!continues)
+  {
+    frontier = idx;
+  }
+  seen_any = true;
+  last_key = idx;
+  last_stride = stride;
+
+  std::vector<int> keys;
+  if (!prefetch.enabled || run < prefetch.confirmations)
+  {
+    return keys;
+  }
+  int64_t lead = (frontier - idx) / stride;
+  if (lead > static_cast<int64_t>(prefetch.degree / 2))
+  {
+    return keys;
+  }
+  int64_t from = std::max<int64_t>(lead, 0) + 1;
+  for (int64_t step = from; step < from + static_cast<int64_t>(prefetch.degree); ++step)
+  {
+    int64_t key = idx + step * stride;
+    if (key < INT32_MIN || key > INT32_MAX)
+    {
+      break;
+    }
+    keys.push_back(static_cast<int>(key));
+    frontier = key;
+  }
+  return keys;
+}
+
+// Caller holds lock. Keys already cached are left alone, the rest come from one Memory pass.
+void Master::_prefetch(const std::vector<int>& keys)
+{
+  std::vector<int> wanted;
+  for (int key : keys)
+  {
+    if (!cache.contains(key))
+    {
+      wanted.push_back(key);
+    }
+  }
+  auto found = mem.getitems(wanted);
+  for (size_t i = 0; i < wanted.size(); ++i)
+  {
+    if (found[i])
+    {
+      cache.insert(wanted[i], std::string(found[i]->second));
+      prefetched.insert(wanted[i]);
+      ++counters.issued;
+    }
+  }
+}
+
+void Master::_worker_loop()
+{
+  std::unique_lock<std::mutex> queued(queue_lock);
+  while (true)
+  {
+    queue_cv.wait(queued, [this] { return stopping || !queue.empty(); });
+    if (stopping)
+    {
+      return;
+    }
+    std::vector<int> keys = std::move(queue.front());
+    queue.pop_front();
+    queued.unlock();
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      _prefetch(keys);
+    }
+    queued.lock();
+  }
+}
+
+void Master::set_prefetch(bool enabled)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  prefetch.enabled = enabled;
+}
+
+PrefetchStats Master::prefetch_stats()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return counters;
+}
+
+NegativeStats Master::negative_stats()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return negative_counters;
 }
 
 void Master::dump_cache()
 {
+  std::lock_guard<std::mutex> guard(lock);
   cache.dumplist();
 }
@@ -1,38 +1,192 @@
 #ifndef MASTER_HPP
 #define MASTER_HPP
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "BloomFilter.hpp"
 #include "LRU.hpp"
 
+// Append-mostly store. Values are packed back to back in one byte arena and described by a
+// struct-of-arrays table (key, offset, length: 12 bytes an entry), so there is no allocation or
+// string header per value and a key scan walks one dense int array. Lookups return the first
+// entry with a matching key or value, as views into the arena that stay valid until the next
+// insert or replace.
 class Memory
 {
 
 private:
-  using datatype = std::pair<int, std::string>;
+  using datatype = std::pair<int, std::string_view>;
   using rettype = std::optional<datatype>;
-  std::vector<datatype> mem;
+  std::vector<int> keys;
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> lengths;
+  std::vector<char> arena;
+
+  datatype _entry(size_t pos) const
+  {
+    return {keys[pos], std::string_view(arena.data() + offsets[pos], lengths[pos])};
+  }
 
 public:
-  rettype getitem(int idx);
-  rettype getitem(const std::string& str);
-  void insert(datatype dat);
+  rettype getitem(int idx) const;
+  rettype getitem(std::string_view str) const;
+  // One pass over the table for a batch of keys; result i answers wanted[i].
+  std::vector<rettype> getitems(const std::vector<int>& wanted) const;
+  void insert(int idx, std::string_view value);
+  // Gives idx's entry a new value: in place if it fits the old bytes, otherwise appended to the
+  // arena with the old bytes left unused. False, and nothing changed, if idx has no entry.
+  bool replace(int idx, std::string_view value);
+  int key_at(size_t pos) const
+  {
+    return keys[pos];
+  }
+  void reserve(size_t entries, size_t bytes);
+
+  size_t size() const
+  {
+    return keys.size();
+  }
+  // Heap bytes held, tables and arena together.
+  size_t footprint() const
+  {
+    return keys.capacity() * sizeof(int) + offsets.capacity() * sizeof(uint32_t) +
+           lengths.capacity() * sizeof(uint32_t) + arena.capacity();
+  }
+};
+
+// Stride prefetcher settings. After `confirmations` fetches in a row with the same non-zero
+// stride, Master pulls the next `degree` keys of the stream from Memory into the cache in one
+// batch, on the caller's thread or on a background worker.
+struct PrefetchConfig
+{
+  bool enabled = true;
+  size_t degree = 8;
+  int confirmations = 2;
+  bool background = false;
+};
+
+struct PrefetchStats
+{
+  size_t hits = 0;   // demand fetches served by the cache
+  size_t misses = 0; // demand fetches that went to Memory
+  size_t issued = 0; // keys prefetched into the cache
+  size_t useful = 0; // prefetched keys a demand fetch hit before they were evicted
+
+  double accuracy() const
+  {
+    return issued ? static_cast<double>(useful) / issued : 0.0;
+  }
+  // Share of would-be misses the prefetcher removed.
+  double coverage() const
+  {
+    return useful + misses ? static_cast<double>(useful) / (useful + misses) : 0.0;
+  }
+};
+
+// Absent-key shortcut. Every stored key goes into a Bloom filter, so a fetch the filter rejects
+// returns without touching the cache or Memory; the filter's false positives that Memory then
+// confirms absent are remembered in a direct-mapped table of `entries` keys, which a store of
+// that key clears.
+struct NegativeConfig
+{
+  bool enabled = true;
+  size_t bits_per_key = 10;
+  size_t entries = 1024;
 };
 
+struct NegativeStats
+{
+  size_t filtered = 0;        // fetches the Bloom filter answered
+  size_t negative_hits = 0;   // filter false positives answered by the negative table
+  size_t false_positives = 0; // filter false positives that cost a Memory scan
+
+  // Share of absent-key fetches that did not reach Memory.
+  double shortcut_ratio() const
+  {
+    size_t absent = filtered + negative_hits + false_positives;
+    return absent ? static_cast<double>(filtered + negative_hits) / absent : 0.0;
+  }
+};
+
+// Safe to share between threads: fetch and store serialise on one lock. A store is
+// last-writer-wins: it replaces the key's value in Memory and drops the key from the cache, then
+// bumps a version counter for its key's stripe, which is what per-thread NearCaches validate
+// against.
 class Master
 {
 private:
   using str = std::optional<std::string>;
+  static constexpr size_t kVersionStripes = 1024;
+
   LRU cache;
   Memory mem;
+  std::mutex lock;
+  std::array<std::atomic<uint64_t>, kVersionStripes> versions{};
+
+  // Negative caching, guarded by lock. The filter is rebuilt twice as large from Memory's keys
+  // whenever it fills up.
+  struct NegativeSlot
+  {
+    int key = 0;
+    bool valid = false;
+  };
+  NegativeConfig negative;
+  NegativeStats negative_counters;
+  BloomFilter filter;
+  std::vector<NegativeSlot> absent;
+
+  // Stride detector and prefetch bookkeeping, guarded by lock.
+  PrefetchConfig prefetch;
+  PrefetchStats counters;
+  std::unordered_set<int> prefetched; // in the cache, not yet hit
+  bool seen_any = false;
+  int last_key = 0;
+  int64_t last_stride = 0;
+  int run = 0;
+  int64_t frontier = 0; // furthest key of the stream already prefetched
+
+  // Background prefetch worker, started only when prefetch.background is set.
+  std::thread worker;
+  std::mutex queue_lock;
+  std::condition_variable queue_cv;
+  std::deque<std::vector<int>> queue;
+  bool stopping = false;
+
+  std::vector<int> _detect(int idx);
+  void _prefetch(const std::vector<int>& keys);
+  void _worker_loop();
+  NegativeSlot& _absent_slot(int idx);
 
 public:
+  explicit Master(PrefetchConfig prefetch = {}, NegativeConfig negative = {});
+  ~Master();
+
   void store(int idx, std::string value);
   str fetch(int idx);
   void dump_cache();
+
+  void set_prefetch(bool enabled);
+  PrefetchStats prefetch_stats();
+  NegativeStats negative_stats();
+
+  // Changes whenever a key sharing idx's stripe is stored; read it before fetching.
+  uint64_t version(int idx) const
+  {
+    return versions[static_cast<uint32_t>(idx) % kVersionStripes].load(std::memory_order_acquire);
+  }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "NearCache.hpp"
+
+NearCache::NearCache(Master& master, size_t capacity)
+    : master(master), entries(capacity ? capacity : 1)
+{
+}
+
+auto NearCache::fetch(int idx) -> std::optional<std::string>
+{
+  Entry& entry = entries[(static_cast<uint32_t>(idx) * 2654435769u) % entries.size()];
+  uint64_t version = master.version(idx);
+  if (entry.valid && entry.key == idx)
+  {
+    if (entry.version == version)
+    {
+      ++hit_count;
+      return entry.value;
+    }
+    ++stale_count;
+  }
+
+  ++miss_count;
+  auto fetched = master.fetch(idx);
+  if (fetched)
+  {
+    entry.key = idx;
+    entry.valid = true;
+    entry.version = version;
+    entry.value = *fetched;
+  }
+  return fetched;
+}
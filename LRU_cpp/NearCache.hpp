@@ -0,0 +1,53 @@
+#ifndef NEAR_CACHE_HPP
+#define NEAR_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Master.hpp"
+
+// Small direct-mapped L1 owned by one thread, in front of a shared Master. A hit costs one
+// version load from Master (a read-shared line that only stores write) instead of Master's lock,
+// so hot keys stay core-local. Entries remember the key's stripe version from before their fill
+// and are dropped once a store has bumped it. Not thread-safe: give each thread its own.
+class NearCache
+{
+private:
+  struct Entry
+  {
+    int key = 0;
+    bool valid = false;
+    uint64_t version = 0;
+    std::string value;
+  };
+
+  Master& master;
+  std::vector<Entry> entries;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+  size_t stale_count = 0;
+
+public:
+  explicit NearCache(Master& master, size_t capacity = 64);
+
+  std::optional<std::string> fetch(int idx);
+
+  size_t hits() const
+  {
+    return hit_count;
+  }
+  size_t misses() const
+  {
+    return miss_count;
+  }
+  // Misses on a resident key whose stripe had been stored to since the fill.
+  size_t invalidations() const
+  {
+    return stale_count;
+  }
+};
+
+#endif
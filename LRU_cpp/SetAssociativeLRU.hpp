@@ -0,0 +1,174 @@
+#ifndef SET_ASSOCIATIVE_LRU_HPP
+#define SET_ASSOCIATIVE_LRU_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Hardware-style counterpart of LRU, after the per-set lru_state of
+// Verilog/TLB/associative_back_cache.v: keys hash to one of a fixed number of sets, each set holds
+// `Ways` entries and a tree of pseudo-LRU bits, and a miss evicts inside its own set only. A set's
+// keys, valid mask and PLRU bits share one 64-byte line, so a lookup is one line of compares with
+// no pointer chasing; the value is only read on a hit. Recency is approximate and conflicts can
+// evict before the cache is full, which costs a little hit ratio against the exact LRU.
+template <size_t Ways = 4>
+class SetAssociativeLRU
+{
+  static_assert(Ways >= 2 && Ways <= 8 && (Ways & (Ways - 1)) == 0,
+                "ways must be a power of two between 2 and 8 to keep a set in one cache line");
+
+private:
+  static constexpr size_t kDefaultCapacity = 20;
+  static constexpr uint32_t kFullMask = (1u << Ways) - 1;
+
+  struct alignas(64) Set
+  {
+    int keys[Ways];
+    uint32_t valid = 0;
+    // Bit n is internal node n of the tree (root is 1); set means the victim is on the right.
+    uint32_t plru = 0;
+  };
+
+  std::vector<Set> sets;
+  std::vector<std::string> values; // set * Ways + way
+  size_t count = 0;
+
+  // Fibonacci hash, then multiply-shift onto [0, sets) so the set count need not be a power of two.
+  size_t _set_of(int idx) const
+  {
+    uint32_t hash = static_cast<uint32_t>(idx) * 2654435769u;
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * sets.size()) >> 32);
+  }
+
+  static int _find(const Set& set, int idx)
+  {
+    for (size_t way = 0; way < Ways; ++way)
+    {
+      if (((set.valid >> way) & 1) && set.keys[way] == idx)
+      {
+        return static_cast<int>(way);
+      }
+    }
+    return -1;
+  }
+
+  // Points every node on the path to `way` at the other half.
+  static void _touch(Set& set, size_t way)
+  {
+    size_t node = 1;
+    for (size_t half = Ways / 2; half > 0; half /= 2)
+    {
+      bool right = (way & half) != 0;
+      set.plru = right ? set.plru & ~(1u << node) : set.plru | (1u << node);
+      node = 2 * node + right;
+    }
+  }
+
+  static size_t _victim(const Set& set)
+  {
+    if (set.valid != kFullMask)
+    {
+      return static_cast<size_t>(__builtin_ctz(~set.valid));
+    }
+    size_t node = 1;
+    while (node < Ways)
+    {
+      node = 2 * node + ((set.plru >> node) & 1);
+    }
+    return node - Ways;
+  }
+
+public:
+  explicit SetAssociativeLRU(size_t capacity = kDefaultCapacity)
+      : sets(capacity > Ways ? (capacity + Ways - 1) / Ways : 1), values(sets.size() * Ways)
+  {
+  }
+
+  std::optional<std::string> getitem(int idx)
+  {
+    size_t index = _set_of(idx);
+    Set& set = sets[index];
+    int way = _find(set, idx);
+    if (way < 0)
+    {
+      return std::nullopt;
+    }
+    _touch(set, static_cast<size_t>(way));
+    return values[index * Ways + way];
+  }
+
+  void dumplist()
+  {
+    int idx = 1;
+    int changeline = 0;
+    for (size_t index = 0; index < sets.size(); ++index)
+    {
+      for (size_t way = 0; way < Ways; ++way)
+      {
+        if (!((sets[index].valid >> way) & 1))
+        {
+          continue;
+        }
+        std::cout << idx << "th item is: " << values[index * Ways + way];
+        idx++;
+        if (changeline == 3)
+        {
+          std::cout << '\n';
+          changeline = 0;
+        }
+        else
+        {
+          std::cout << '\t';
+          changeline++;
+        }
+      }
+    }
+  }
+
+  bool remove(int idx)
+  {
+    size_t index = _set_of(idx);
+    Set& set = sets[index];
+    int way = _find(set, idx);
+    if (way < 0)
+    {
+      return false;
+    }
+    set.valid &= ~(1u << way);
+    values[index * Ways + way].clear();
+    --count;
+    return true;
+  }
+
+  // Replaces the value if the key is resident, otherwise fills the set's PLRU victim.
+  bool insert(int idx, std::string&& str)
+  {
+    size_t index = _set_of(idx);
+    Set& set = sets[index];
+    int found = _find(set, idx);
+    size_t way = found >= 0 ? static_cast<size_t>(found) : _victim(set);
+    if (found < 0)
+    {
+      count += ((set.valid >> way) & 1) ? 0 : 1;
+      set.keys[way] = idx;
+      set.valid |= 1u << way;
+    }
+    values[index * Ways + way] = std::move(str);
+    _touch(set, way);
+    return true;
+  }
+
+  size_t size() const
+  {
+    return count;
+  }
+  size_t capacity() const
+  {
+    return sets.size() * Ways;
+  }
+};
+
+#endif
@@ -0,0 +1,545 @@
+#include "SharedLRU.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <pthread.h>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t kMagic = 0x4c525553; // "SURL"
+constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+constexpr size_t kAlign = 64;
+
+size_t align_up(size_t n)
+{
+  return (n + kAlign - 1) / kAlign * kAlign;
+}
+
+[[noreturn]] void throw_errno(const std::string& what)
+{
+  throw std::system_error(errno, std::generic_category(), what);
+}
+} // namespace
+
+struct SharedLRU::Header
+{
+  std::atomic<uint32_t> ready; // kMagic once formatted
+  uint32_t bucket_bits;
+  uint64_t capacity;
+  uint64_t max_value_bytes;
+  pthread_mutex_t mutex;
+  uint32_t head; // most recent
+  uint32_t tail;
+  uint32_t free_head;
+  uint32_t size;
+  uint64_t clock;
+  uint64_t recoveries;
+};
+
+struct SharedLRU::Node
+{
+  int key;
+  uint32_t prev;
+  uint32_t next;  // recency list, or the free list when not live
+  uint32_t chain; // hash bucket chain
+  uint32_t length;
+  uint64_t stamp;
+  std::atomic<uint8_t> live;
+};
+
+namespace
+{
+struct Layout
+{
+  size_t buckets;
+  size_t nodes;
+  size_t values;
+  size_t total;
+};
+
+template <typename Header, typename Node>
+Layout layout_of(size_t capacity, size_t max_value_bytes, uint32_t bucket_bits)
+{
+  Layout layout;
+  layout.buckets = align_up(sizeof(Header));
+  layout.nodes = layout.buckets + align_up((size_t{1} << bucket_bits) * sizeof(uint32_t));
+  layout.values = layout.nodes + align_up(capacity * sizeof(Node));
+  layout.total = layout.values + capacity * max_value_bytes;
+  return layout;
+}
+
+uint32_t bucket_bits_for(size_t capacity)
+{
+  uint32_t bits = 1;
+  while ((size_t{1} << bits) < 2 * capacity)
+  {
+    ++bits;
+  }
+  return bits;
+}
+} // namespace
+
+auto SharedLRU::_header() const -> Header*
+{
+  return static_cast<Header*>(base);
+}
+
+uint32_t* SharedLRU::_bucket(int key) const
+{
+  return &buckets[(static_cast<uint32_t>(key) * 2654435769u) >> (32 - _header()->bucket_bits)];
+}
+
+char* SharedLRU::_value(uint32_t node) const
+{
+  return values + node * _header()->max_value_bytes;
+}
+
+// Caches where the tables start in this process's mapping; needs the header's geometry.
+void SharedLRU::_map_tables()
+{
+  Header* header = _header();
+  auto layout = layout_of<Header, Node>(header->capacity, header->max_value_bytes,
+                                        header->bucket_bits);
+  buckets = reinterpret_cast<uint32_t*>(static_cast<char*>(base) + layout.buckets);
+  nodes = reinterpret_cast<Node*>(static_cast<char*>(base) + layout.nodes);
+  values = static_cast<char*>(base) + layout.values;
+}
+
+// Holds the segment's mutex; takes over and repairs the index if its last owner died.
+struct SharedLRU::Guard
+{
+  SharedLRU& cache;
+  explicit Guard(SharedLRU& cache) : cache(cache)
+  {
+    cache._lock();
+  }
+  ~Guard()
+  {
+    cache._unlock();
+  }
+};
+
+void SharedLRU::_lock()
+{
+  pthread_mutex_t* mutex = &_header()->mutex;
+  int rc = pthread_mutex_lock(mutex);
+  if (rc == EOWNERDEAD)
+  {
+    _recover();
+    rc = pthread_mutex_consistent(mutex);
+  }
+  if (rc != 0)
+  {
+    throw std::system_error(rc, std::generic_category(), "SharedLRU lock " + name);
+  }
+}
+
+void SharedLRU::_unlock()
+{
+  pthread_mutex_unlock(&_header()->mutex);
+}
+
+SharedLRU::SharedLRU(const std::string& name, size_t capacity, size_t max_value_bytes)
+    : name(name)
+{
+  if (capacity == 0 || capacity >= kNil || max_value_bytes == 0 ||
+      max_value_bytes > std::numeric_limits<uint32_t>::max())
+  {
+    throw std::invalid_argument("SharedLRU capacity and value size must fit in 32 bits");
+  }
+  uint32_t bucket_bits = bucket_bits_for(capacity);
+  bytes = layout_of<Header, Node>(capacity, max_value_bytes, bucket_bits).total;
+
+  // Opening and formatting serialise on an flock of the segment. The kernel drops it if its
+  // holder dies, so a process killed half way through formatting leaves a segment whose `ready`
+  // is still unset, and the next one to open it formats it from scratch.
+  fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd < 0)
+  {
+    throw_errno("shm_open " + name);
+  }
+
+  try
+  {
+    while (::flock(fd, LOCK_EX) != 0)
+    {
+      if (errno != EINTR)
+      {
+        throw_errno("flock " + name);
+      }
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+      throw_errno("fstat " + name);
+    }
+    bool formatted = false;
+    if (static_cast<size_t>(st.st_size) >= sizeof(Header))
+    {
+      _map(static_cast<size_t>(st.st_size));
+      formatted = _header()->ready.load(std::memory_order_acquire) == kMagic;
+      if (formatted && (_header()->capacity != capacity ||
+                        _header()->max_value_bytes != max_value_bytes ||
+                        static_cast<size_t>(st.st_size) != bytes))
+      {
+        throw std::invalid_argument("SharedLRU segment " + name + " has a different geometry");
+      }
+      if (!formatted)
+      {
+        ::munmap(base, static_cast<size_t>(st.st_size));
+        base = nullptr;
+      }
+    }
+
+    if (formatted)
+    {
+      _map_tables();
+    }
+    else
+    {
+      // Truncating to nothing first discards whatever a dead formatter left, so the segment
+      // starts zero-filled.
+      if (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+      {
+        throw_errno("ftruncate " + name);
+      }
+      _map(bytes);
+      _initialise(capacity, max_value_bytes);
+    }
+    ::flock(fd, LOCK_UN);
+  }
+  catch (...)
+  {
+    if (base)
+    {
+      ::munmap(base, mapped);
+    }
+    ::close(fd); // also releases the flock
+    throw;
+  }
+}
+
+void SharedLRU::_map(size_t length)
+{
+  base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+  {
+    base = nullptr;
+    throw_errno("mmap " + name);
+  }
+  mapped = length;
+}
+
+SharedLRU::~SharedLRU()
+{
+  ::munmap(base, mapped);
+  ::close(fd);
+}
+
+void SharedLRU::unlink(const std::string& name)
+{
+  if (::shm_unlink(name.c_str()) != 0 && errno != ENOENT)
+  {
+    throw_errno("shm_unlink " + name);
+  }
+}
+
+// Runs under the flock, before `ready` lets anyone else in. The fresh mapping is zero-filled,
+// which is a valid state for the atomics.
+void SharedLRU::_initialise(size_t capacity, size_t max_value_bytes)
+{
+  Header* header = _header();
+  header->bucket_bits = bucket_bits_for(capacity);
+  header->capacity = capacity;
+  header->max_value_bytes = max_value_bytes;
+  header->head = kNil;
+  header->tail = kNil;
+  header->size = 0;
+  header->clock = 0;
+  header->recoveries = 0;
+
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+  int rc = pthread_mutex_init(&header->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  if (rc != 0)
+  {
+    throw std::system_error(rc, std::generic_category(), "SharedLRU mutex " + name);
+  }
+
+  _map_tables();
+  std::fill_n(buckets, size_t{1} << header->bucket_bits, kNil);
+  for (uint32_t i = 0; i < header->capacity; ++i)
+  {
+    nodes[i].next = i + 1 < header->capacity ? i + 1 : kNil;
+  }
+  header->free_head = 0;
+  header->ready.store(kMagic, std::memory_order_release);
+}
+
+// Caller holds the lock after EOWNERDEAD. Everything but the nodes' key, value, stamp and live
+// flag may be half-updated, so the buckets, recency list and free list are rebuilt from those.
+void SharedLRU::_recover()
+{
+  Header* header = _header();
+  std::fill_n(buckets, size_t{1} << header->bucket_bits, kNil);
+  header->head = kNil;
+  header->tail = kNil;
+  header->free_head = kNil;
+  header->size = 0;
+
+  std::vector<uint32_t> live;
+  for (uint32_t i = 0; i < header->capacity; ++i)
+  {
+    Node& node = nodes[i];
+    if (!node.live.load(std::memory_order_acquire))
+    {
+      continue;
+    }
+    uint32_t other = _find(node.key);
+    if (other != kNil && nodes[other].stamp > node.stamp)
+    {
+      node.live.store(0, std::memory_order_release);
+      continue;
+    }
+    if (other != kNil)
+    {
+      _unhash(other);
+      nodes[other].live.store(0, std::memory_order_release);
+    }
+    uint32_t* bucket = _bucket(node.key);
+    node.chain = *bucket;
+    *bucket = i;
+    header->clock = std::max(header->clock, node.stamp);
+    live.push_back(i);
+  }
+
+  std::sort(live.begin(), live.end(),
+            [this](uint32_t a, uint32_t b) { return nodes[a].stamp < nodes[b].stamp; });
+  for (uint32_t i : live)
+  {
+    if (nodes[i].live.load(std::memory_order_relaxed))
+    {
+      _link_front(i);
+      ++header->size;
+    }
+  }
+  for (uint32_t i = static_cast<uint32_t>(header->capacity); i-- > 0;)
+  {
+    if (!nodes[i].live.load(std::memory_order_relaxed))
+    {
+      nodes[i].next = header->free_head;
+      header->free_head = i;
+    }
+  }
+  ++header->recoveries;
+}
+
+uint32_t SharedLRU::_find(int key) const
+{
+  uint32_t i = *_bucket(key);
+  while (i != kNil && nodes[i].key != key)
+  {
+    i = nodes[i].chain;
+  }
+  return i;
+}
+
+void SharedLRU::_link_front(uint32_t node)
+{
+  Header* header = _header();
+  nodes[node].prev = kNil;
+  nodes[node].next = header->head;
+  if (header->head != kNil)
+  {
+    nodes[header->head].prev = node;
+  }
+  header->head = node;
+  if (header->tail == kNil)
+  {
+    header->tail = node;
+  }
+}
+
+void SharedLRU::_unlink(uint32_t node)
+{
+  Header* header = _header();
+  Node& n = nodes[node];
+  (n.prev != kNil ? nodes[n.prev].next : header->head) = n.next;
+  (n.next != kNil ? nodes[n.next].prev : header->tail) = n.prev;
+}
+
+void SharedLRU::_unhash(uint32_t node)
+{
+  uint32_t* link = _bucket(nodes[node].key);
+  while (*link != node)
+  {
+    link = &nodes[*link].chain;
+  }
+  *link = nodes[node].chain;
+}
+
+// Node must already be off the recency list and its hash chain.
+void SharedLRU::_release(uint32_t node)
+{
+  Header* header = _header();
+  Node& n = nodes[node];
+  n.live.store(0, std::memory_order_release);
+  n.next = header->free_head;
+  header->free_head = node;
+  --header->size;
+}
+
+// Takes a free node, evicting the least recently used one if there is none.
+uint32_t SharedLRU::_allocate()
+{
+  Header* header = _header();
+  if (header->free_head == kNil)
+  {
+    uint32_t victim = header->tail;
+    _unlink(victim);
+    _unhash(victim);
+    _release(victim);
+  }
+  uint32_t node = header->free_head;
+  header->free_head = nodes[node].next;
+  return node;
+}
+
+auto SharedLRU::getitem(int idx) -> std::optional<std::string>
+{
+  Guard guard(*this);
+  uint32_t node = _find(idx);
+  if (node == kNil)
+  {
+    return std::nullopt;
+  }
+  Node& n = nodes[node];
+  n.stamp = ++_header()->clock;
+  if (_header()->head != node)
+  {
+    _unlink(node);
+    _link_front(node);
+  }
+  return std::string(_value(node), n.length);
+}
+
+bool SharedLRU::contains(int idx)
+{
+  Guard guard(*this);
+  return _find(idx) != kNil;
+}
+
+bool SharedLRU::insert(int idx, std::string_view value)
+{
+  Header* header = _header();
+  if (value.size() > header->max_value_bytes)
+  {
+    return false;
+  }
+  Guard guard(*this);
+  uint32_t old = _find(idx);
+  if (old != kNil && header->free_head == kNil && header->tail == old)
+  {
+    // The only node to evict is the old value itself.
+    _unlink(old);
+    _unhash(old);
+    _release(old);
+    old = kNil;
+  }
+
+  uint32_t node = _allocate();
+  Node& n = nodes[node];
+  n.key = idx;
+  n.length = static_cast<uint32_t>(value.size());
+  n.stamp = ++header->clock;
+  std::memcpy(_value(node), value.data(), value.size());
+  n.live.store(1, std::memory_order_release);
+
+  uint32_t* bucket = _bucket(idx);
+  if (old != kNil)
+  {
+    _unhash(old);
+  }
+  n.chain = *bucket;
+  *bucket = node;
+  _link_front(node);
+  ++header->size;
+  if (old != kNil)
+  {
+    _unlink(old);
+    _release(old);
+  }
+  return true;
+}
+
+bool SharedLRU::remove(int idx)
+{
+  Guard guard(*this);
+  uint32_t node = _find(idx);
+  if (node == kNil)
+  {
+    return false;
+  }
+  _unlink(node);
+  _unhash(node);
+  _release(node);
+  return true;
+}
+
+size_t SharedLRU::size()
+{
+  Guard guard(*this);
+  return _header()->size;
+}
+
+size_t SharedLRU::capacity() const
+{
+  return _header()->capacity;
+}
+
+uint64_t SharedLRU::recoveries()
+{
+  Guard guard(*this);
+  return _header()->recoveries;
+}
+
+bool SharedLRU::verify()
+{
+  Guard guard(*this);
+  Header* header = _header();
+  size_t listed = 0;
+  uint32_t prev = kNil;
+  for (uint32_t i = header->head; i != kNil; i = nodes[i].next)
+  {
+    if (++listed > header->capacity || nodes[i].prev != prev || !nodes[i].live.load() ||
+        _find(nodes[i].key) != i)
+    {
+      return false;
+    }
+    prev = i;
+  }
+  size_t free = 0;
+  for (uint32_t i = header->free_head; i != kNil; i = nodes[i].next)
+  {
+    if (++free > header->capacity || nodes[i].live.load())
+    {
+      return false;
+    }
+  }
+  return prev == header->tail && listed == header->size && listed + free == header->capacity;
+}
@@ -0,0 +1,82 @@
+#ifndef SHARED_LRU_HPP
+#define SHARED_LRU_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// LRU whose whole state lives in one POSIX shared-memory segment, so processes on a host that
+// open the same name share one cache. Links are node indices rather than pointers, which keeps
+// the segment valid at whatever address each process maps it. Every operation takes one
+// process-shared robust mutex in the segment header.
+//
+// Segment layout: header, hash buckets, nodes, then one fixed value slot of max_value_bytes per
+// node. The node table is the source of truth: a node's key and value are written before its
+// `live` flag is set, an update writes a fresh node before retiring the old one, and every use
+// stamps the node from a global counter. The hash chains and the recency list are derived from
+// that, so when a process dies holding the lock the next one to take it rebuilds both from the
+// live nodes, keeping the newest stamp for a key that appears twice.
+class SharedLRU
+{
+private:
+  struct Header;
+  struct Node;
+  struct Guard;
+
+  std::string name;
+  int fd = -1;
+  void* base = nullptr;
+  size_t bytes = 0;
+  size_t mapped = 0; // length of the current mapping
+  // Where the tables start in this process's mapping.
+  uint32_t* buckets = nullptr;
+  Node* nodes = nullptr;
+  char* values = nullptr;
+
+  Header* _header() const;
+  uint32_t* _bucket(int key) const;
+  char* _value(uint32_t node) const;
+
+  void _lock();
+  void _unlock();
+  void _map(size_t length);
+  void _initialise(size_t capacity, size_t max_value_bytes);
+  void _map_tables();
+  void _recover();
+
+  uint32_t _find(int key) const;
+  void _link_front(uint32_t node);
+  void _unlink(uint32_t node);
+  void _unhash(uint32_t node);
+  void _release(uint32_t node);
+  uint32_t _allocate();
+
+public:
+  // Opens the segment `name` (e.g. "/lru-cache"), creating and formatting it if it does not
+  // exist or was left unformatted by a process that died formatting it. Throws std::system_error if the segment cannot be opened or mapped, and
+  // std::invalid_argument if it exists with a different capacity or value size.
+  SharedLRU(const std::string& name, size_t capacity, size_t max_value_bytes);
+  ~SharedLRU();
+  SharedLRU(const SharedLRU&) = delete;
+  SharedLRU& operator=(const SharedLRU&) = delete;
+
+  // Removes the name; processes that still have it mapped keep working on their mapping.
+  static void unlink(const std::string& name);
+
+  std::optional<std::string> getitem(int idx);
+  bool contains(int idx);
+  // False if the value does not fit in a slot.
+  bool insert(int idx, std::string_view value);
+  bool remove(int idx);
+
+  size_t size();
+  size_t capacity() const;
+  // Times a process found the lock abandoned and rebuilt the index.
+  uint64_t recoveries();
+  // Walks the index under the lock and checks it against the node table.
+  bool verify();
+};
+
+#endif
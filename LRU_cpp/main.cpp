@@ -1,8 +1,624 @@
+#include "Compress.hpp"
 #include "Master.hpp"
+#include "NearCache.hpp"
+#include "SetAssociativeLRU.hpp"
+#include "SharedLRU.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <list>
+#include <optional>
 #include <random>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
+namespace
+{
+// Read-through replay against one cache: look up, and on a miss insert as Master::fetch would.
+template <typename Cache>
+void compare_mode(const char* name, Cache&& cache, const std::vector<int>& keys)
+{
+  int hits = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int key : keys)
+  {
+    if (cache.getitem(key))
+    {
+      ++hits;
+    }
+    else
+    {
+      cache.insert(key, "value-" + std::to_string(key));
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  std::cout << name << ": hit ratio=" << static_cast<double>(hits) / keys.size()
+            << ", ns/op=" << ns / keys.size() << '\n';
+}
+
+// Exact LRU with O(1) eviction: list nodes carry their key, and the index is a hash map. The
+// yardstick for SetAssociativeLRU, since LRU's eviction scans its whole map for the tail's key.
+class HashedLRU
+{
+private:
+  size_t capacity;
+  std::list<std::pair<int, std::string>> items; // most recent first
+  std::unordered_map<int, std::list<std::pair<int, std::string>>::iterator> index;
+
+public:
+  explicit HashedLRU(size_t capacity) : capacity(capacity)
+  {
+    index.reserve(capacity);
+  }
+
+  std::optional<std::string> getitem(int idx)
+  {
+    auto it = index.find(idx);
+    if (it == index.end())
+    {
+      return std::nullopt;
+    }
+    items.splice(items.begin(), items, it->second);
+    return it->second->second;
+  }
+
+  void insert(int idx, std::string&& value)
+  {
+    auto it = index.find(idx);
+    if (it != index.end())
+    {
+      it->second->second = std::move(value);
+      items.splice(items.begin(), items, it->second);
+      return;
+    }
+    if (items.size() == capacity)
+    {
+      index.erase(items.back().first);
+      items.pop_back();
+    }
+    items.emplace_front(idx, std::move(value));
+    index.emplace(idx, items.begin());
+  }
+};
+
+// Zipf(s) over [0, keys): a precomputed CDF searched per draw.
+std::vector<int> zipf_keys(int keys, double s, size_t count, uint32_t seed)
+{
+  std::vector<double> cdf(keys);
+  double sum = 0;
+  for (int k = 0; k < keys; ++k)
+  {
+    sum += 1.0 / std::pow(k + 1, s);
+    cdf[k] = sum;
+  }
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<> uniform(0, sum);
+  std::vector<int> out(count);
+  for (auto& key : out)
+  {
+    key = static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), uniform(gen)) - cdf.begin());
+  }
+  return out;
+}
+
+// Every thread replays its own Zipf stream against one shared Master, storing once per
+// kStoreEvery lookups, either straight through Master::fetch or through its own NearCache.
+void near_cache_load(Master& master, int keys, unsigned threads, bool near)
+{
+  constexpr size_t kLookups = 500000;
+  constexpr size_t kStoreEvery = 1000;
+  std::vector<std::vector<int>> streams;
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    streams.push_back(zipf_keys(keys, 0.99, kLookups, 1000 + t));
+  }
+  std::vector<size_t> near_hits(threads);
+  std::vector<size_t> near_stale(threads);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    pool.emplace_back([&, t] {
+      NearCache l1(master);
+      for (size_t i = 0; i < kLookups; ++i)
+      {
+        int key = streams[t][i];
+        if (i % kStoreEvery == kStoreEvery - 1)
+        {
+          master.store(key, "updated-" + std::to_string(key));
+        }
+        else if (near)
+        {
+          l1.fetch(key);
+        }
+        else
+        {
+          master.fetch(key);
+        }
+      }
+      near_hits[t] = l1.hits();
+      near_stale[t] = l1.invalidations();
+    });
+  }
+  for (auto& thread : pool)
+  {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  size_t hits = 0;
+  size_t stale = 0;
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    hits += near_hits[t];
+    stale += near_stale[t];
+  }
+  std::cout << "  " << (near ? "near cache" : "shared only") << ", " << threads
+            << " thread(s): " << kLookups * threads / seconds / 1e6 << " M ops/s";
+  if (near)
+  {
+    std::cout << ", L1 hit ratio=" << static_cast<double>(hits) / (kLookups * threads)
+              << ", invalidations=" << stale;
+  }
+  std::cout << '\n';
+}
+
+template <typename F>
+double seconds_of(F&& fn)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  fn();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// The arena-backed Memory against the vector<pair<int, string>> layout it replaced, on the same
+// multi-million entry store: build time, heap footprint and full-scan lookups by key and value.
+void memory_layout(size_t entries)
+{
+  constexpr size_t kKeyLookups = 100;
+  constexpr size_t kValueLookups = 20;
+  constexpr size_t kShortString = 15; // longest value libstdc++ keeps inside the string
+
+  std::vector<std::pair<int, std::string>> legacy;
+  Memory arena;
+  double legacy_build = seconds_of([&] {
+    for (size_t i = 0; i < entries; ++i)
+    {
+      legacy.emplace_back(static_cast<int>(i), "stored-value-" + std::to_string(i));
+    }
+  });
+  double arena_build = seconds_of([&] {
+    for (size_t i = 0; i < entries; ++i)
+    {
+      arena.insert(static_cast<int>(i), "stored-value-" + std::to_string(i));
+    }
+  });
+
+  size_t legacy_bytes = legacy.capacity() * sizeof(legacy[0]);
+  for (const auto& item : legacy)
+  {
+    legacy_bytes += item.second.capacity() > kShortString ? item.second.capacity() + 1 : 0;
+  }
+
+  size_t found = 0;
+  double legacy_keys = seconds_of([&] {
+    for (size_t q = 0; q < kKeyLookups; ++q)
+    {
+      int key = static_cast<int>(entries - 1 - q * (entries / kKeyLookups));
+      for (const auto& item : legacy)
+      {
+        if (item.first == key)
+        {
+          found += item.second.size();
+          break;
+        }
+      }
+    }
+  });
+  double arena_keys = seconds_of([&] {
+    for (size_t q = 0; q < kKeyLookups; ++q)
+    {
+      int key = static_cast<int>(entries - 1 - q * (entries / kKeyLookups));
+      if (auto item = arena.getitem(key))
+      {
+        found += item->second.size();
+      }
+    }
+  });
+  double legacy_values = seconds_of([&] {
+    for (size_t q = 0; q < kValueLookups; ++q)
+    {
+      std::string value = "stored-value-" + std::to_string(entries - 1 - q);
+      for (const auto& item : legacy)
+      {
+        if (item.second == value)
+        {
+          found += item.first;
+          break;
+        }
+      }
+    }
+  });
+  double arena_values = seconds_of([&] {
+    for (size_t q = 0; q < kValueLookups; ++q)
+    {
+      std::string value = "stored-value-" + std::to_string(entries - 1 - q);
+      if (auto item = arena.getitem(value))
+      {
+        found += item->first;
+      }
+    }
+  });
+
+  std::cout << "\nMemory layout, " << entries << " entries (checksum " << found << "):\n"
+            << "  pair<int, string>: build " << legacy_build << " s, " << legacy_bytes / 1e6
+            << " MB, key scan " << legacy_keys / kKeyLookups * 1e3 << " ms, value scan "
+            << legacy_values / kValueLookups * 1e3 << " ms\n"
+            << "  arena + SoA:       build " << arena_build << " s, " << arena.footprint() / 1e6
+            << " MB, key scan " << arena_keys / kKeyLookups * 1e3 << " ms, value scan "
+            << arena_values / kValueLookups * 1e3 << " ms\n";
+}
+
+// The same access pattern against masters that only differ in prefetch settings.
+void prefetch_modes()
+{
+  constexpr int kKeys = 20000;
+  constexpr int kPasses = 5;
+  struct Mode
+  {
+    const char* name;
+    PrefetchConfig config;
+  };
+  const Mode modes[] = {
+      {"off", {false, 8, 2, false}},
+      {"inline, degree 8", {true, 8, 2, false}},
+      {"background, degree 8", {true, 8, 2, true}},
+  };
+  const char* const patterns[] = {"sequential", "stride 3", "random"};
+
+  std::cout << "\nPrefetch, " << kKeys << " stored keys, " << kPasses << " passes:\n";
+  for (int pattern = 0; pattern < 3; ++pattern)
+  {
+    std::vector<int> keys;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> any(0, kKeys - 1);
+    for (int pass = 0; pass < kPasses; ++pass)
+    {
+      for (int i = 0; i < kKeys / 10; ++i)
+      {
+        keys.push_back(pattern == 0 ? pass * (kKeys / 10) + i : pattern == 1 ? i * 3 : any(gen));
+      }
+    }
+    for (const Mode& mode : modes)
+    {
+      Master master(mode.config);
+      for (int i = 0; i < kKeys; ++i)
+      {
+        master.store(i, "prefetch-value-" + std::to_string(i));
+      }
+      double seconds = seconds_of([&] {
+        for (int key : keys)
+        {
+          master.fetch(key);
+        }
+      });
+      PrefetchStats stats = master.prefetch_stats();
+      std::cout << "  " << patterns[pattern] << ", " << mode.name << ": hits=" << stats.hits
+                << ", misses=" << stats.misses << ", issued=" << stats.issued
+                << ", accuracy=" << stats.accuracy() << ", coverage=" << stats.coverage()
+                << ", us/fetch=" << seconds / keys.size() * 1e6 << '\n';
+    }
+  }
+}
+// Lookups of never-stored keys, which without the filter each cost a full Memory scan, next to
+// lookups of stored keys, which the filter must not slow down.
+void negative_modes()
+{
+  constexpr int kKeys = 20000;
+  constexpr int kAbsentKeys = 20000;
+  constexpr int kLookups = 50000;
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<> stored(0, kKeys - 1);
+  std::uniform_int_distribution<> missing(0, kAbsentKeys - 1);
+  std::vector<int> present_keys(kLookups);
+  std::vector<int> absent_keys(kLookups);
+  for (int i = 0; i < kLookups; ++i)
+  {
+    present_keys[i] = stored(gen) * 2;            // even keys are stored
+    absent_keys[i] = missing(gen) * 2 * 7919 + 1; // odd ones never are
+  }
+
+  std::cout << "\nNegative caching, " << kKeys << " stored keys, " << kLookups
+            << " lookups each of stored keys and of " << kAbsentKeys << " absent keys:\n";
+  for (bool enabled : {false, true})
+  {
+    Master master({false, 8, 2, false}, {enabled, 10, 1024});
+    for (int i = 0; i < kKeys; ++i)
+    {
+      master.store(i * 2, "negative-value-" + std::to_string(i));
+    }
+    size_t found = 0;
+    double present = seconds_of([&] {
+      for (int key : present_keys)
+      {
+        found += master.fetch(key).has_value();
+      }
+    });
+    double absent = seconds_of([&] {
+      for (int key : absent_keys)
+      {
+        found += master.fetch(key).has_value();
+      }
+    });
+    if (found != present_keys.size())
+    {
+      throw std::logic_error("negative caching changed a lookup result");
+    }
+    NegativeStats stats = master.negative_stats();
+    std::cout << "  " << (enabled ? "filter + negative table" : "off") << ": ns/present fetch="
+              << present / kLookups * 1e9 << ", ns/absent fetch=" << absent / kLookups * 1e9
+              << ", filtered=" << stats.filtered << ", negative hits=" << stats.negative_hits
+              << ", false positives=" << stats.false_positives << '\n';
+  }
+}
+
+// Runs fn in `processes` forked children and returns the sum of what they report back.
+template <typename F>
+uint64_t in_children(int processes, F&& fn)
+{
+  int fds[2];
+  if (::pipe(fds) != 0)
+  {
+    throw std::runtime_error("pipe failed");
+  }
+  std::cout.flush();
+  for (int child = 0; child < processes; ++child)
+  {
+    if (::fork() == 0)
+    {
+      ::close(fds[0]);
+      uint64_t result = fn(child);
+      ssize_t written = ::write(fds[1], &result, sizeof(result));
+      ::_exit(written == sizeof(result) ? 0 : 1);
+    }
+  }
+  ::close(fds[1]);
+  uint64_t total = 0;
+  uint64_t result;
+  while (::read(fds[0], &result, sizeof(result)) == sizeof(result))
+  {
+    total += result;
+  }
+  ::close(fds[0]);
+  while (::wait(nullptr) > 0)
+  {
+  }
+  return total;
+}
+
+// Read-through Zipf replay against a SharedLRU opened by name in the calling process.
+uint64_t shared_replay(const std::string& name, size_t capacity, int keys, size_t lookups,
+                       uint32_t seed)
+{
+  SharedLRU cache(name, capacity, 64);
+  uint64_t hits = 0;
+  for (int key : zipf_keys(keys, 0.9, lookups, seed))
+  {
+    if (cache.getitem(key))
+    {
+      ++hits;
+    }
+    else
+    {
+      cache.insert(key, "shared-value-" + std::to_string(key));
+    }
+  }
+  return hits;
+}
+
+// Worker processes with a private cache each against the same processes sharing one segment of
+// the same size, then a writer killed over and over mid-update to exercise lock recovery.
+void shared_processes()
+{
+  constexpr int kProcesses = 4;
+  constexpr size_t kCapacity = 1024;
+  constexpr int kKeys = 8192;
+  constexpr uint64_t kLookups = 200000;
+  const std::string name = "/lru_cpp-" + std::to_string(::getpid());
+
+  std::cout << "\nShared-memory LRU, " << kProcesses << " processes, Zipf(0.9) over " << kKeys
+            << " keys, " << kLookups << " lookups each:\n";
+  SharedLRU::unlink(name);
+  uint64_t private_hits = 0;
+  double private_seconds = seconds_of([&] {
+    private_hits = in_children(kProcesses, [&](int child) {
+      std::string own = name + "-" + std::to_string(child);
+      uint64_t hits = shared_replay(own, kCapacity, kKeys, kLookups, 100 + child);
+      SharedLRU::unlink(own);
+      return hits;
+    });
+  });
+  std::cout << "  private, " << kProcesses << " x " << kCapacity << " entries: hit ratio="
+            << static_cast<double>(private_hits) / (kProcesses * kLookups)
+            << ", ns/op=" << private_seconds / (kProcesses * kLookups) * 1e9 << '\n';
+
+  SharedLRU shared(name, kCapacity, 64);
+  uint64_t shared_hits = 0;
+  double shared_seconds = seconds_of([&] {
+    shared_hits = in_children(kProcesses, [&](int child) {
+      return shared_replay(name, kCapacity, kKeys, kLookups, 100 + child);
+    });
+  });
+  std::cout << "  shared, 1 x " << kCapacity << " entries:  hit ratio="
+            << static_cast<double>(shared_hits) / (kProcesses * kLookups)
+            << ", ns/op=" << shared_seconds / (kProcesses * kLookups) * 1e9
+            << ", index " << (shared.verify() ? "consistent" : "CORRUPT") << '\n';
+
+  constexpr int kKills = 50;
+  for (int round = 0; round < kKills; ++round)
+  {
+    std::cout.flush();
+    pid_t writer = ::fork();
+    if (writer == 0)
+    {
+      SharedLRU cache(name, kCapacity, 64);
+      for (int key = 0;; key = (key + 7) % kKeys)
+      {
+        cache.insert(key, "killed-writer-" + std::to_string(key));
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ::kill(writer, SIGKILL);
+    ::waitpid(writer, nullptr, 0);
+  }
+  std::cout << "  " << kKills << " writers killed: " << shared.recoveries()
+            << " found holding the lock and recovered, size=" << shared.size()
+            << ", index " << (shared.verify() ? "consistent" : "CORRUPT") << '\n';
+  SharedLRU::unlink(name);
+
+  // A creator killed half way through formatting: it holds the segment's flock and has sized
+  // and scribbled over the segment, but not marked it ready.
+  std::cout.flush();
+  pid_t creator = ::fork();
+  if (creator == 0)
+  {
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 || ::flock(fd, LOCK_EX) != 0 || ::ftruncate(fd, 1 << 20) != 0)
+    {
+      ::_exit(1);
+    }
+    void* half = ::mmap(nullptr, 1 << 20, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (half != MAP_FAILED)
+    {
+      std::memset(static_cast<char*>(half) + 8, 0xab, (1 << 20) - 8);
+    }
+    ::raise(SIGKILL);
+  }
+  ::waitpid(creator, nullptr, 0);
+  bool reopened = false;
+  double reopen_seconds = seconds_of([&] {
+    SharedLRU cache(name, kCapacity, 64);
+    reopened = cache.insert(1, "after-dead-creator") && cache.getitem(1) == "after-dead-creator" &&
+               cache.size() == 1 && cache.verify();
+  });
+  std::cout << "  creator killed mid-format: reopened and reformatted in " << reopen_seconds * 1e3
+            << " ms, " << (reopened ? "working" : "BROKEN") << '\n';
+  SharedLRU::unlink(name);
+}
+
+// Text-like values: about 500 bytes of sentences drawn from a small vocabulary, as a page of
+// rendered text or a JSON blob would be.
+std::vector<std::string> text_values(int keys)
+{
+  const char* const words[] = {"cache", "entry", "the", "value", "of", "tier", "evicted",
+                               "request", "memory", "and", "budget", "is", "compressed",
+                               "a", "key", "hit", "miss", "for", "latency", "page"};
+  std::mt19937 gen(11);
+  std::uniform_int_distribution<> pick(0, 19);
+  std::vector<std::string> values(keys);
+  for (int key = 0; key < keys; ++key)
+  {
+    std::string& value = values[key];
+    value = "{\"id\": " + std::to_string(key) + ", \"text\": \"";
+    while (value.size() < 500)
+    {
+      value += words[pick(gen)];
+      value += ' ';
+    }
+    value += "\"}";
+  }
+  return values;
+}
+
+// Read-through replay like compare_mode, with tier-2 promotions counted apart from tier-1 hits.
+void tiered_mode(const char* name, LRU&& cache, const std::vector<std::string>& values,
+                 const std::vector<int>& keys)
+{
+  size_t hits = 0;
+  double seconds = seconds_of([&] {
+    for (int key : keys)
+    {
+      if (cache.getitem(key))
+      {
+        ++hits;
+      }
+      else
+      {
+        cache.insert(key, std::string(values[key]));
+      }
+    }
+  });
+  const CompressedTier* tier2 = cache.second_tier();
+  size_t promoted = tier2 ? tier2->hits() : 0;
+  std::cout << "  " << name
+            << ": tier-1 hit ratio=" << static_cast<double>(hits - promoted) / keys.size()
+            << ", tier-2 hit ratio=" << static_cast<double>(promoted) / keys.size()
+            << ", ns/op=" << seconds / keys.size() * 1e9 << '\n';
+  if (tier2)
+  {
+    std::cout << "    tier 2 holds " << tier2->size() << " entries in " << tier2->compressed_bytes()
+              << " bytes (" << tier2->raw_bytes() << " raw, ratio "
+              << static_cast<double>(tier2->raw_bytes()) / tier2->compressed_bytes() << "), "
+              << tier2->evictions() << " evictions, " << tier2->rejections()
+              << " values not admitted\n";
+  }
+}
+
+// The second tier gets the same byte budget as the raw values tier 1 holds, so it answers how
+// many more entries that memory keeps once compressed.
+void second_tier_modes()
+{
+  constexpr size_t kCapacity = 256;
+  constexpr int kKeys = 4096;
+  std::vector<std::string> values = text_values(kKeys);
+  size_t tier1_bytes = 0;
+  for (size_t key = 0; key < kCapacity; ++key)
+  {
+    tier1_bytes += values[key].size();
+  }
+  for (const auto& value : values)
+  {
+    std::string block = lz_compress(value);
+    if (lz_decompress(block, value.size()) != value)
+    {
+      throw std::logic_error("lz round trip mismatch");
+    }
+  }
+  // A key demoted to tier 2 must not come back after remove. Tier 2 admits a key on its second
+  // eviction, so 0 is evicted twice before it is there to remove.
+  LRU demoted(1, tier1_bytes);
+  demoted.insert(0, "zero");
+  demoted.insert(1, "one");
+  demoted.insert(0, "zero");
+  demoted.insert(1, "one");
+  if (demoted.second_tier()->size() != 1 || !demoted.remove(0) || demoted.getitem(0))
+  {
+    throw std::logic_error("remove left a demoted key in tier 2");
+  }
+  std::vector<int> keys = zipf_keys(kKeys, 0.9, 1000000, 5);
+
+  std::cout << "\nCompressed second tier, capacity " << kCapacity << ", ~500-byte text values, "
+            << "Zipf(0.9) over " << kKeys << " keys:\n";
+  tiered_mode("LRU only", LRU(kCapacity), values, keys);
+  tiered_mode("LRU + tier 2", LRU(kCapacity, tier1_bytes), values, keys);
+}
+} // namespace
+
 int main()
 {
   Master master;
@@ -46,6 +662,11 @@ int main()
     }
   }
   std::cout << "Sequential reads: hits=" << seq_hits << ", misses=" << seq_misses << '\n';
+  PrefetchStats seq_prefetch = master.prefetch_stats();
+  std::cout << "  cache hits=" << seq_prefetch.hits << ", cache misses=" << seq_prefetch.misses
+            << ", prefetched=" << seq_prefetch.issued
+            << ", prefetch accuracy=" << seq_prefetch.accuracy()
+            << ", coverage=" << seq_prefetch.coverage() << '\n';
 
   // Random read: fetch the random indices
   int rand_hits = 0;
@@ -83,6 +704,60 @@ int main()
   }
   std::cout << "Extra random queries: hits=" << extra_hits << ", misses=" << extra_misses << '\n';
 
+  // Exact LRU against the set-associative mode on the same skewed stream: 80% of the lookups go
+  // to a hot fifth of the keys, with room in the cache for about a third of the hot keys.
+  constexpr size_t kModeCapacity = 256;
+  constexpr int kModeKeys = 4096;
+  constexpr int kModeQueries = 1000000;
+  std::uniform_int_distribution<> hot(0, kModeKeys / 5 - 1);
+  std::uniform_int_distribution<> cold(0, kModeKeys - 1);
+  std::bernoulli_distribution pick_hot(0.8);
+  std::vector<int> mode_keys;
+  mode_keys.reserve(kModeQueries);
+  for (int query = 0; query < kModeQueries; ++query)
+  {
+    mode_keys.push_back(pick_hot(gen) ? hot(gen) : cold(gen));
+  }
+  std::cout << "\nCache modes, capacity " << kModeCapacity << ", " << kModeQueries
+            << " skewed lookups:\n";
+  compare_mode("LRU (exact)", LRU(kModeCapacity), mode_keys);
+  compare_mode("HashedLRU (exact, O(1) eviction)", HashedLRU(kModeCapacity), mode_keys);
+  compare_mode("SetAssociativeLRU<2>", SetAssociativeLRU<2>(kModeCapacity), mode_keys);
+  compare_mode("SetAssociativeLRU<4>", SetAssociativeLRU<4>(kModeCapacity), mode_keys);
+  compare_mode("SetAssociativeLRU<8>", SetAssociativeLRU<8>(kModeCapacity), mode_keys);
+
+  // A store must be what the next fetch sees, through a NearCache as well as directly.
+  {
+    Master updated;
+    NearCache l1(updated);
+    updated.store(7, "old");
+    auto before = l1.fetch(7);
+    updated.store(7, "new");
+    if (before != "old" || l1.fetch(7) != "new" || updated.fetch(7) != "new")
+    {
+      throw std::logic_error("store did not replace the fetched value");
+    }
+  }
+
+  // Per-thread near caches in front of the shared master, under Zipf(0.99) lookups.
+  std::cout << "\nNear cache, Zipf(0.99) over " << kMaxIndex + 1 << " keys:\n";
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads))
+  {
+    near_cache_load(master, kMaxIndex + 1, threads, false);
+    near_cache_load(master, kMaxIndex + 1, threads, true);
+    if (threads == max_threads)
+    {
+      break;
+    }
+  }
+
+  memory_layout(4000000);
+  prefetch_modes();
+  negative_modes();
+  second_tier_modes();
+  shared_processes();
+
   // Dump all items in cache at the end
   std::cout << "\nDumping cache contents:\n";
   master.dump_cache();
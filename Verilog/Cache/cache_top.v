@@ -0,0 +1,19 @@
+`timescale 1ns / 1ps
+
+// top.v without CPU.v: Cache.v and main_memory.v with the CPU side of the cache brought out as
+// ports, so a testbench or a Verilated C++ harness can drive its own request stream.
+module cache_top(
+    input wire read_write_cache, /* 1 if write, 0 if read */
+    input wire [9:0] address_cache,
+    input wire [31:0] write_data_cache,
+    output wire [31:0] read_data_cache,
+    output wire hit_miss /* 1 if hit, 0 if miss */
+    );
+    // interface between cache and main memory
+    wire [31:0]  write_data_mem, read_data_mem;
+    wire [9:0]   address_mem;
+    wire read_write_mem, Done;
+
+    Cache   Cache(read_write_cache, address_cache, write_data_cache, Done, read_data_mem, read_data_cache, hit_miss, read_write_mem, address_mem, write_data_mem);
+    main_memory            mem_db(read_write_mem, address_mem, write_data_mem, read_data_mem, Done);
+endmodule
@@ -75,57 +75,57 @@ module associative_back_cache(
         // if (Valid & isTag) hit_miss = 1;
             if(read_write_cache) begin // This is a write in instruction. sw
                 if (hit_miss) begin // There is data in the cache now. Then just write in the data. 
-                    if (hit_A) begin             
+                    if (way0_hit) begin             
                         // block A is the required position.   
-                        if(Byte_offset == 2'b00) begin // sw
-                            case (Word_offset)
-                                2'b00: block[{setIndex,1'b0}][127:96] = write_data_cache;
-                                2'b01: block[{setIndex,1'b0}][95:64] = write_data_cache;
-                                2'b10: block[{setIndex,1'b0}][63:32] = write_data_cache;
-                                2'b11: block[{setIndex,1'b0}][31:0] = write_data_cache;
-                                default: block[{setIndex,1'b0}] = 0;
+                        if(byte_offset_select == 2'b00) begin // sw
+                            case (word_offset_select)
+                                2'b00: line_storage[{active_set,1'b0}][127:96] = write_data_cache;
+                                2'b01: line_storage[{active_set,1'b0}][95:64] = write_data_cache;
+                                2'b10: line_storage[{active_set,1'b0}][63:32] = write_data_cache;
+                                2'b11: line_storage[{active_set,1'b0}][31:0] = write_data_cache;
+                                default: line_storage[{active_set,1'b0}] = 0;
                             endcase
                         end
                         else begin // sb
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            block[{setIndex,1'b0}][i-:8] = write_data_cache;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            line_storage[{active_set,1'b0}][i-:8] = write_data_cache;
                         end
-                        block[{setIndex,1'b0}][cache_width-2] = 1'b1; // Set Dirty bit to dirty. 
-                        dirty[{setIndex,1'b0}] = 1'b1;
-                        LRU[setIndex] = 1'b1;
+                        line_storage[{active_set,1'b0}][cache_width-2] = 1'b1; // Set Dirty bit to dirty. 
+                        line_dirty[{active_set,1'b0}] = 1'b1;
+                        lru_state[active_set] = 1'b1;
                     end
-                    else if (hit_B) begin
-                        if (Byte_offset == 2'b00) begin
-                            case (Word_offset)
-                                2'b00: block[{setIndex,1'b1}][127:96] = write_data_cache;
-                                2'b01: block[{setIndex,1'b1}][95:64] = write_data_cache;
-                                2'b10: block[{setIndex,1'b1}][63:32] = write_data_cache;
-                                2'b11: block[{setIndex,1'b1}][31:0] = write_data_cache;
-                                default: block[{setIndex,1'b1}] = 0;
+                    else if (way1_hit) begin
+                        if (byte_offset_select == 2'b00) begin
+                            case (word_offset_select)
+                                2'b00: line_storage[{active_set,1'b1}][127:96] = write_data_cache;
+                                2'b01: line_storage[{active_set,1'b1}][95:64] = write_data_cache;
+                                2'b10: line_storage[{active_set,1'b1}][63:32] = write_data_cache;
+                                2'b11: line_storage[{active_set,1'b1}][31:0] = write_data_cache;
+                                default: line_storage[{active_set,1'b1}] = 0;
                             endcase
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            block[{setIndex,1'b1}][i-:8] = write_data_cache;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            line_storage[{active_set,1'b1}][i-:8] = write_data_cache;
                         end
-                        block[{setIndex,1'b1}][cache_width-2] = 1'b1; // Set Dirty bit to dirty. 
-                        dirty[{setIndex,1'b1}] = 1'b1;
-                        LRU[setIndex] = 1'b0;
+                        line_storage[{active_set,1'b1}][cache_width-2] = 1'b1; // Set Dirty bit to dirty. 
+                        line_dirty[{active_set,1'b1}] = 1'b1;
+                        lru_state[active_set] = 1'b0;
                     end
                 end
 
                 else if (!hit_miss) begin
-                    if (LRU[setIndex] == 1'b0) begin
-                        if (Dirty_A) begin // Need to write back to Main Memory first, then change the cache. 
+                    if (lru_state[active_set] == 1'b0) begin
+                        if (way0_dirty) begin // Need to write back to Main Memory first, then change the cache. 
                             read_write_mem = 1'b1; // Write to main memory. 
-                            address_mem = {{Tag_A, setIndex}, {4{1'b0}}}; // Start from word0.
+                            address_mem = {{way0_tag, active_set}, {4{1'b0}}}; // Start from word0.
                             for (i = 0; i < 4; i = i + 1) begin
                                 // address_mem = {Tag, blockIndex, i[1:0]};
                                 case (i)
-                                    0: write_data_mem = block_A[127:96];
-                                    1: write_data_mem = block_A[95:64];
-                                    2: write_data_mem = block_A[63:32];
-                                    3: write_data_mem = block_A[31:0];
+                                    0: write_data_mem = way0_line[127:96];
+                                    1: write_data_mem = way0_line[95:64];
+                                    2: write_data_mem = way0_line[63:32];
+                                    3: write_data_mem = way0_line[31:0];
                                     default: write_data_mem = 32'b0;
                                 endcase
                                 @(posedge done) begin
@@ -141,49 +141,49 @@ module associative_back_cache(
                         for (i = 0; i < 4; i = i + 1) begin
                             @(posedge done) begin
                                 case (i)
-                                    0: block[{setIndex,1'b0}][127:96] = read_data_mem;
-                                    1: block[{setIndex,1'b0}][95:64] = read_data_mem;
-                                    2: block[{setIndex,1'b0}][63:32] = read_data_mem;
-                                    3: block[{setIndex,1'b0}][31:0] = read_data_mem;
-                                    default: block[{setIndex,1'b0}] = 0;
+                                    0: line_storage[{active_set,1'b0}][127:96] = read_data_mem;
+                                    1: line_storage[{active_set,1'b0}][95:64] = read_data_mem;
+                                    2: line_storage[{active_set,1'b0}][63:32] = read_data_mem;
+                                    3: line_storage[{active_set,1'b0}][31:0] = read_data_mem;
+                                    default: line_storage[{active_set,1'b0}] = 0;
                                 endcase
                                 address_mem = address_mem + 4;
                             end
                         end
 
-                        block[{setIndex,1'b0}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
-                        valid[{setIndex,1'b0}] = 1'b1;
-                        block[{setIndex,1'b0}][cache_width-2] = 1'b1; // Set Dirty bit = 1.
-                        dirty[{setIndex,1'b0}] = 1'b1;
-                        block[{setIndex,1'b0}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
-                        tag[{setIndex,1'b0}] = address_cache[9:5];
-                        LRU[setIndex] = 1'b1;
+                        line_storage[{active_set,1'b0}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
+                        line_valid[{active_set,1'b0}] = 1'b1;
+                        line_storage[{active_set,1'b0}][cache_width-2] = 1'b1; // Set Dirty bit = 1.
+                        line_dirty[{active_set,1'b0}] = 1'b1;
+                        line_storage[{active_set,1'b0}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
+                        line_tag[{active_set,1'b0}] = address_cache[9:5];
+                        lru_state[active_set] = 1'b1;
 
-                        if(Byte_offset == 2'b00) begin // sw
-                            case (Word_offset)
-                                2'b00: block[{setIndex,1'b0}][127:96] = write_data_cache;
-                                2'b01: block[{setIndex,1'b0}][95:64] = write_data_cache;
-                                2'b10: block[{setIndex,1'b0}][63:32] = write_data_cache;
-                                2'b11: block[{setIndex,1'b0}][31:0] = write_data_cache;
-                                default: block[{setIndex,1'b0}] = 0;
+                        if(byte_offset_select == 2'b00) begin // sw
+                            case (word_offset_select)
+                                2'b00: line_storage[{active_set,1'b0}][127:96] = write_data_cache;
+                                2'b01: line_storage[{active_set,1'b0}][95:64] = write_data_cache;
+                                2'b10: line_storage[{active_set,1'b0}][63:32] = write_data_cache;
+                                2'b11: line_storage[{active_set,1'b0}][31:0] = write_data_cache;
+                                default: line_storage[{active_set,1'b0}] = 0;
                             endcase
                         end
                         else begin // sb
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            block[{setIndex,1'b0}][i-:8] = write_data_cache;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            line_storage[{active_set,1'b0}][i-:8] = write_data_cache;
                         end                   
                     end
                     else begin
-                        if (Dirty_B) begin // Need to write back to Main Memory first, then change the cache. 
+                        if (way1_dirty) begin // Need to write back to Main Memory first, then change the cache. 
                             read_write_mem = 1'b1; // Write to main memory. 
-                            address_mem = {{Tag_B, setIndex}, {4{1'b0}}}; // Start from word0.
+                            address_mem = {{way1_tag, active_set}, {4{1'b0}}}; // Start from word0.
                             for (i = 0; i < 4; i = i + 1) begin
                                 // address_mem = {Tag, blockIndex, i[1:0]};
                                 case (i)
-                                    0: write_data_mem = block_B[127:96];
-                                    1: write_data_mem = block_B[95:64];
-                                    2: write_data_mem = block_B[63:32];
-                                    3: write_data_mem = block_B[31:0];
+                                    0: write_data_mem = way1_line[127:96];
+                                    1: write_data_mem = way1_line[95:64];
+                                    2: write_data_mem = way1_line[63:32];
+                                    3: write_data_mem = way1_line[31:0];
                                     default: write_data_mem = 32'b0;
                                 endcase
                                 @(posedge done) begin
@@ -199,36 +199,36 @@ module associative_back_cache(
                         for (i = 0; i < 4; i = i + 1) begin
                             @(posedge done) begin
                                 case (i)
-                                    0: block[{setIndex,1'b1}][127:96] = read_data_mem;
-                                    1: block[{setIndex,1'b1}][95:64] = read_data_mem;
-                                    2: block[{setIndex,1'b1}][63:32] = read_data_mem;
-                                    3: block[{setIndex,1'b1}][31:0] = read_data_mem;
-                                    default: block[{setIndex,1'b1}] = 0;
+                                    0: line_storage[{active_set,1'b1}][127:96] = read_data_mem;
+                                    1: line_storage[{active_set,1'b1}][95:64] = read_data_mem;
+                                    2: line_storage[{active_set,1'b1}][63:32] = read_data_mem;
+                                    3: line_storage[{active_set,1'b1}][31:0] = read_data_mem;
+                                    default: line_storage[{active_set,1'b1}] = 0;
                                 endcase
                                 address_mem = address_mem + 4;
                             end
                         end
 
-                        block[{setIndex,1'b1}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
-                        valid[{setIndex,1'b1}] = 1'b1;
-                        block[{setIndex,1'b1}][cache_width-2] = 1'b1; // Set Dirty bit = 1.
-                        dirty[{setIndex,1'b1}] = 1'b1;
-                        block[{setIndex,1'b1}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
-                        tag[{setIndex,1'b1}] = address_cache[9:5];
-                        LRU[{setIndex,1'b1}] = 1'b0;
+                        line_storage[{active_set,1'b1}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
+                        line_valid[{active_set,1'b1}] = 1'b1;
+                        line_storage[{active_set,1'b1}][cache_width-2] = 1'b1; // Set Dirty bit = 1.
+                        line_dirty[{active_set,1'b1}] = 1'b1;
+                        line_storage[{active_set,1'b1}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
+                        line_tag[{active_set,1'b1}] = address_cache[9:5];
+                        lru_state[{active_set,1'b1}] = 1'b0;
 
-                        if (Byte_offset == 2'b00) begin
-                            case (Word_offset)
-                                2'b00: block[{setIndex,1'b1}][127:96] = write_data_cache;
-                                2'b01: block[{setIndex,1'b1}][95:64] = write_data_cache;
-                                2'b10: block[{setIndex,1'b1}][63:32] = write_data_cache;
-                                2'b11: block[{setIndex,1'b1}][31:0] = write_data_cache;
-                                default: block[{setIndex,1'b1}] = 0;
+                        if (byte_offset_select == 2'b00) begin
+                            case (word_offset_select)
+                                2'b00: line_storage[{active_set,1'b1}][127:96] = write_data_cache;
+                                2'b01: line_storage[{active_set,1'b1}][95:64] = write_data_cache;
+                                2'b10: line_storage[{active_set,1'b1}][63:32] = write_data_cache;
+                                2'b11: line_storage[{active_set,1'b1}][31:0] = write_data_cache;
+                                default: line_storage[{active_set,1'b1}] = 0;
                             endcase
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            block[{setIndex,1'b1}][i-:8] = write_data_cache;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            line_storage[{active_set,1'b1}][i-:8] = write_data_cache;
                         end                     
                     end
                 end
@@ -236,44 +236,44 @@ module associative_back_cache(
 
             else begin // read data instruction // lw. 
                 if (hit_miss) begin // data is already in cache.
-                    if (hit_A) begin
-                        if (Byte_offset == 2'b00) begin
-                            i = 127 - 32 * Word_offset;
-                            read_data_cache = block[{setIndex,1'b0}][i-:32];
-                            LRU[setIndex] = 1'b1;
+                    if (way0_hit) begin
+                        if (byte_offset_select == 2'b00) begin
+                            i = 127 - 32 * word_offset_select;
+                            read_data_cache = line_storage[{active_set,1'b0}][i-:32];
+                            lru_state[active_set] = 1'b1;
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            read_data_cache = block[{setIndex,1'b0}][i-:8];
-                            LRU[setIndex] = 1'b1;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            read_data_cache = line_storage[{active_set,1'b0}][i-:8];
+                            lru_state[active_set] = 1'b1;
                         end
                     end
-                    else if (hit_B) begin
-                        if (Byte_offset == 2'b00) begin
-                            i = 127 - 32 * Word_offset;
-                            read_data_cache = block[{setIndex,1'b1}][i-:32];
-                            LRU[setIndex] = 1'b0;
+                    else if (way1_hit) begin
+                        if (byte_offset_select == 2'b00) begin
+                            i = 127 - 32 * word_offset_select;
+                            read_data_cache = line_storage[{active_set,1'b1}][i-:32];
+                            lru_state[active_set] = 1'b0;
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            read_data_cache = block[{setIndex,1'b1}][i-:8];
-                            LRU[setIndex] = 1'b0;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            read_data_cache = line_storage[{active_set,1'b1}][i-:8];
+                            lru_state[active_set] = 1'b0;
                         end
                     end
 
                 end
 
                 else if (!hit_miss) begin // Replace refer to LRU
-                    if (LRU[setIndex] == 1'b0) begin // Replace set A.
-                        if (Dirty_A) begin // Need to write back to Main Memory first, then change the cache. 
+                    if (lru_state[active_set] == 1'b0) begin // Replace set A.
+                        if (way0_dirty) begin // Need to write back to Main Memory first, then change the cache. 
                             read_write_mem = 1'b1; // Write to main memory. 
-                            address_mem = {{Tag_A, setIndex}, {4{1'b0}}}; // Start from word0.
+                            address_mem = {{way0_tag, active_set}, {4{1'b0}}}; // Start from word0.
                             for (i = 0; i < 4; i = i + 1) begin
                                 case (i)
-                                    0: write_data_mem = block_A[127:96];
-                                    1: write_data_mem = block_A[95:64];
-                                    2: write_data_mem = block_A[63:32];
-                                    3: write_data_mem = block_A[31:0];
+                                    0: write_data_mem = way0_line[127:96];
+                                    1: write_data_mem = way0_line[95:64];
+                                    2: write_data_mem = way0_line[63:32];
+                                    3: write_data_mem = way0_line[31:0];
                                     default: write_data_mem = 32'b0;
                                 endcase
 
@@ -291,45 +291,45 @@ module associative_back_cache(
                         for (i = 0; i < 4; i = i + 1) begin
                             @(posedge done) begin
                                 case (i)
-                                    0: block[{setIndex,1'b0}][127:96] = read_data_mem;
-                                    1: block[{setIndex,1'b0}][95:64] = read_data_mem;
-                                    2: block[{setIndex,1'b0}][63:32] = read_data_mem;
-                                    3: block[{setIndex,1'b0}][31:0] = read_data_mem;
-                                    default: block[{setIndex,1'b0}] = 0;
+                                    0: line_storage[{active_set,1'b0}][127:96] = read_data_mem;
+                                    1: line_storage[{active_set,1'b0}][95:64] = read_data_mem;
+                                    2: line_storage[{active_set,1'b0}][63:32] = read_data_mem;
+                                    3: line_storage[{active_set,1'b0}][31:0] = read_data_mem;
+                                    default: line_storage[{active_set,1'b0}] = 0;
                                 endcase
                                 address_mem = address_mem + 4;
                             end
                         end
                         
-                        block[{setIndex,1'b0}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
-                        valid[{setIndex,1'b0}] = 1'b1;
-                        block[{setIndex,1'b0}][cache_width-2] = 1'b0; // Set Dirty bit = 0.
-                        dirty[{setIndex,1'b0}] = 1'b0;
-                        block[{setIndex,1'b0}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
-                        tag[{setIndex,1'b0}] = address_cache[9:5];
+                        line_storage[{active_set,1'b0}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
+                        line_valid[{active_set,1'b0}] = 1'b1;
+                        line_storage[{active_set,1'b0}][cache_width-2] = 1'b0; // Set Dirty bit = 0.
+                        line_dirty[{active_set,1'b0}] = 1'b0;
+                        line_storage[{active_set,1'b0}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
+                        line_tag[{active_set,1'b0}] = address_cache[9:5];
 
-                        if (Byte_offset == 2'b00) begin
-                            i = 127 - 32 * Word_offset;
-                            read_data_cache = block[{setIndex,1'b0}][i-:32];
-                            LRU[setIndex] = 1'b1;
+                        if (byte_offset_select == 2'b00) begin
+                            i = 127 - 32 * word_offset_select;
+                            read_data_cache = line_storage[{active_set,1'b0}][i-:32];
+                            lru_state[active_set] = 1'b1;
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            read_data_cache = block[{setIndex,1'b0}][i-:8];
-                            LRU[setIndex] = 1'b1;
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            read_data_cache = line_storage[{active_set,1'b0}][i-:8];
+                            lru_state[active_set] = 1'b1;
                         end
                     end
 
-                    else begin // LRU[setIndex] = 1'b1; Least used block is in set B. 
-                            if (Dirty_B) begin // Need to write back to Main Memory first, then change the cache. 
+                    else begin // lru_state[active_set] = 1'b1; Least used block is in set B. 
+                            if (way1_dirty) begin // Need to write back to Main Memory first, then change the cache. 
                             read_write_mem = 1'b1; // Write to main memory. 
-                            address_mem = {{Tag_B, setIndex}, {4{1'b0}}}; // Start from word0.
+                            address_mem = {{way1_tag, active_set}, {4{1'b0}}}; // Start from word0.
                             for (i = 0; i < 4; i = i + 1) begin
                                 case (i)
-                                    0: write_data_mem = block_B[127:96];
-                                    1: write_data_mem = block_B[95:64];
-                                    2: write_data_mem = block_B[63:32];
-                                    3: write_data_mem = block_B[31:0];
+                                    0: write_data_mem = way1_line[127:96];
+                                    1: write_data_mem = way1_line[95:64];
+                                    2: write_data_mem = way1_line[63:32];
+                                    3: write_data_mem = way1_line[31:0];
                                     default: write_data_mem = 32'b0;
                                 endcase
 
@@ -347,32 +347,32 @@ module associative_back_cache(
                         for (i = 0; i < 4; i = i + 1) begin
                             @(posedge done) begin
                                 case (i)
-                                    0: block[{setIndex,1'b1}][127:96] = read_data_mem;
-                                    1: block[{setIndex,1'b1}][95:64] = read_data_mem;
-                                    2: block[{setIndex,1'b1}][63:32] = read_data_mem;
-                                    3: block[{setIndex,1'b1}][31:0] = read_data_mem;
-                                    default: block[{setIndex,1'b1}] = 0;
+                                    0: line_storage[{active_set,1'b1}][127:96] = read_data_mem;
+                                    1: line_storage[{active_set,1'b1}][95:64] = read_data_mem;
+                                    2: line_storage[{active_set,1'b1}][63:32] = read_data_mem;
+                                    3: line_storage[{active_set,1'b1}][31:0] = read_data_mem;
+                                    default: line_storage[{active_set,1'b1}] = 0;
                                 endcase
                                 address_mem = address_mem + 4;
                             end
                         end
                         
-                        block[{setIndex,1'b1}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
-                        valid[{setIndex,1'b1}] = 1'b1;
-                        block[{setIndex,1'b1}][cache_width-2] = 1'b0; // Set Dirty bit = 0.
-                        dirty[{setIndex,1'b1}] = 1'b0;
-                        block[{setIndex,1'b1}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
-                        tag[{setIndex,1'b1}] = address_cache[9:5];
+                        line_storage[{active_set,1'b1}][cache_width-1] = 1'b1; //  Set Valid bit = 1.
+                        line_valid[{active_set,1'b1}] = 1'b1;
+                        line_storage[{active_set,1'b1}][cache_width-2] = 1'b0; // Set Dirty bit = 0.
+                        line_dirty[{active_set,1'b1}] = 1'b0;
+                        line_storage[{active_set,1'b1}][cache_width-3:cache_width-7] = address_cache[9:5]; // Update the tag. 
+                        line_tag[{active_set,1'b1}] = address_cache[9:5];
 
-                        if (Byte_offset == 2'b00) begin
-                            i = 127 - 32 * Word_offset;
-                            read_data_cache = block[{setIndex,1'b1}][i-:32];
-                            LRU[setIndex] = 1'b0;     
+                        if (byte_offset_select == 2'b00) begin
+                            i = 127 - 32 * word_offset_select;
+                            read_data_cache = line_storage[{active_set,1'b1}][i-:32];
+                            lru_state[active_set] = 1'b0;     
                         end
                         else begin
-                            i = 127 - 32 * Word_offset - 8 * (3-Byte_offset);
-                            read_data_cache = block[{setIndex,1'b1}][i-:8];
-                            LRU[setIndex] = 1'b0;    
+                            i = 127 - 32 * word_offset_select - 8 * (3-byte_offset_select);
+                            read_data_cache = line_storage[{active_set,1'b1}][i-:8];
+                            lru_state[active_set] = 1'b0;    
                         end
                     end
                 end
@@ -0,0 +1,74 @@
+`timescale 1ns / 1ps
+
+// vm_test.v without the processor: TLB, page table, cache and main memory wired as in the
+// testbench, with the processor side brought out as ports so a testbench or a Verilated C++
+// harness can drive its own request stream. page_fault is exposed so the driver can skip a
+// faulting request the way vm_test.v's notes describe.
+module vm_top(
+    input wire read_write, // 1'b1 write, 1'b0 read
+    input wire [13:0] virtual_address,
+    input wire [31:0] write_data_cache,
+    output wire [31:0] read_data_cache,
+    output wire hit_miss,
+    output wire page_fault
+    );
+    wire [9:0]   physical_address;
+    wire [1:0]   physical_page_tag;
+    wire PA_done, read_write_cache, done;
+    wire [31:0]  read_data_mem, write_data_mem;
+    wire [9:0]   address_mem;
+    wire [5:0]   virtual_page_tag;
+    wire read_write_mem, PT_done, read_write_PT;
+    wire dirty_write_back;
+    wire dirty_fetched;
+    wire reference_write_back;
+    wire reference_fetched;
+
+    associative_back_cache cache(
+        .read_write_cache(read_write_cache),
+        .address_cache(physical_address),
+        .write_data_cache(write_data_cache),
+        .read_data_mem(read_data_mem),
+        .done(done),
+        .PA_done(PA_done),
+        .read_data_cache(read_data_cache),
+        .hit_miss(hit_miss),
+        .read_write_mem(read_write_mem),
+        .address_mem(address_mem),
+        .write_data_mem(write_data_mem)
+    );
+    translation_look_aside_buffer TLB(
+        .virtual_address(virtual_address),
+        .input_read_write(read_write),
+        .physical_page_tag(physical_page_tag),
+        .PT_done(PT_done),
+        .page_fault(page_fault),
+        .dirty_fetched(dirty_fetched),
+        .reference_fetched(reference_fetched),
+        .physical_address(physical_address),
+        .output_read_write(read_write_cache),
+        .virtual_page_tag(virtual_page_tag),
+        .PA_done(PA_done),
+        .read_write_PT(read_write_PT),
+        .dirty_write_back(dirty_write_back),
+        .reference_write_back(reference_write_back)
+    );
+    main_mem memory(
+        .read_write_mem(read_write_mem),
+        .address_mem(address_mem),
+        .write_data_mem(write_data_mem),
+        .read_data_mem(read_data_mem),
+        .done(done)
+    );
+    page_table PT(
+        .read_write_PT(read_write_PT),
+        .virtual_page_tag(virtual_page_tag),
+        .dirty_write_back(dirty_write_back),
+        .reference_write_back(reference_write_back),
+        .physical_page_tag(physical_page_tag),
+        .page_fault(page_fault),
+        .PT_done(PT_done),
+        .dirty_fetched(dirty_fetched),
+        .reference_fetched(reference_fetched)
+    );
+endmodule
@@ -0,0 +1,267 @@
+#ifndef ASSOC_CACHE_HPP
+#define ASSOC_CACHE_HPP
+
+#include "cache.hpp"
+#include "trace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Bitmask of the ways in keys[0, ways) equal to key. Tags of a set are stored contiguously, so
+// this is a handful of vector compares rather than a loop over lines.
+inline uint64_t match_ways(const uint32_t* keys, uint32_t ways, uint32_t key)
+{
+  uint64_t mask = 0;
+  uint32_t way = 0;
+#if defined(__AVX2__)
+  __m256i needle8 = _mm256_set1_epi32(static_cast<int>(key));
+  for (; way + 8 <= ways; way += 8)
+  {
+    __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + way));
+    auto bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lane, needle8)));
+    mask |= static_cast<uint64_t>(bits) << way;
+  }
+#endif
+#if defined(__SSE2__)
+  __m128i needle4 = _mm_set1_epi32(static_cast<int>(key));
+  for (; way + 4 <= ways; way += 4)
+  {
+    __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + way));
+    auto bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lane, needle4)));
+    mask |= static_cast<uint64_t>(bits) << way;
+  }
+#endif
+  for (; way < ways; ++way)
+  {
+    mask |= static_cast<uint64_t>(keys[way] == key) << way;
+  }
+  return mask;
+}
+
+// Replacement policies. Each sees hits (touch), fills into a chosen way (fill), and picks a
+// victim once the set has no invalid way left.
+
+// Exact LRU via per-line last-use stamps.
+class LruPolicy
+{
+private:
+  uint32_t ways;
+  uint64_t clock = 0;
+  std::vector<uint64_t> stamps;
+
+public:
+  LruPolicy(uint32_t sets, uint32_t ways) : ways(ways), stamps(static_cast<size_t>(sets) * ways, 0)
+  {
+  }
+  void touch(uint32_t set, uint32_t way)
+  {
+    stamps[static_cast<size_t>(set) * ways + way] = ++clock;
+  }
+  void fill(uint32_t set, uint32_t way)
+  {
+    touch(set, way);
+  }
+  uint32_t victim(uint32_t set) const
+  {
+    const uint64_t* row = &stamps[static_cast<size_t>(set) * ways];
+    uint32_t oldest = 0;
+    uint64_t oldest_stamp = row[0];
+    for (uint32_t way = 1; way < ways; ++way)
+    {
+      bool older = row[way] < oldest_stamp;
+      oldest = older ? way : oldest;
+      oldest_stamp = older ? row[way] : oldest_stamp;
+    }
+    return oldest;
+  }
+};
+
+// Tree pseudo-LRU: ways - 1 direction bits per set, heap-ordered from node 1. Each bit points at
+// the half to evict next. With 2 ways this is exactly the single lru_state bit per set of
+// associative_back_cache.v.
+class TreePlruPolicy
+{
+private:
+  uint32_t ways;
+  uint32_t levels;
+  std::vector<uint64_t> trees;
+
+public:
+  TreePlruPolicy(uint32_t sets, uint32_t ways)
+      : ways(ways), levels(static_cast<uint32_t>(__builtin_ctz(ways))), trees(sets, 0)
+  {
+    if (ways > 64)
+    {
+      throw std::invalid_argument("tree-PLRU supports at most 64 ways");
+    }
+  }
+  void touch(uint32_t set, uint32_t way)
+  {
+    uint64_t tree = trees[set];
+    uint32_t node = 1;
+    for (uint32_t level = levels; level-- > 0;)
+    {
+      uint64_t toward = (way >> level) & 1;
+      // point away from the half just used
+      tree = (tree & ~(1ull << node)) | ((toward ^ 1) << node);
+      node = node * 2 + static_cast<uint32_t>(toward);
+    }
+    trees[set] = tree;
+  }
+  void fill(uint32_t set, uint32_t way)
+  {
+    touch(set, way);
+  }
+  uint32_t victim(uint32_t set) const
+  {
+    uint64_t tree = trees[set];
+    uint32_t node = 1;
+    for (uint32_t level = 0; level < levels; ++level)
+    {
+      node = node * 2 + static_cast<uint32_t>((tree >> node) & 1);
+    }
+    return node - ways;
+  }
+};
+
+// Round-robin over the ways in fill order; hits do not matter.
+class FifoPolicy
+{
+private:
+  uint32_t ways;
+  std::vector<uint32_t> next;
+
+public:
+  FifoPolicy(uint32_t sets, uint32_t ways) : ways(ways), next(sets, 0)
+  {
+  }
+  void touch(uint32_t, uint32_t)
+  {
+  }
+  void fill(uint32_t set, uint32_t way)
+  {
+    if (way == next[set])
+    {
+      next[set] = (next[set] + 1) & (ways - 1);
+    }
+  }
+  uint32_t victim(uint32_t set) const
+  {
+    return next[set];
+  }
+};
+
+class RandomPolicy
+{
+private:
+  uint32_t ways;
+  uint32_t state = 0x9e3779b9u;
+
+public:
+  RandomPolicy(uint32_t, uint32_t ways) : ways(ways)
+  {
+  }
+  void touch(uint32_t, uint32_t)
+  {
+  }
+  void fill(uint32_t, uint32_t)
+  {
+  }
+  uint32_t victim(uint32_t)
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state & (ways - 1);
+  }
+};
+
+struct AccessResult
+{
+  bool hit;
+  bool write_back;
+  uint32_t way;
+};
+
+// N-way set-associative, write-back, write-allocate cache modelled on
+// Verilog/TLB/associative_back_cache.v. Invalid ways are filled first, then the policy picks.
+// Metadata is structure-of-arrays: one contiguous row of keys per set ((tag << 1) | valid, 0 when
+// invalid) for the vector tag compare, plus a dirty bitmask per set.
+template <typename Policy> class SetAssociativeCache
+{
+private:
+  AddressSplit split;
+  uint32_t ways;
+  std::vector<uint32_t> keys;
+  std::vector<uint64_t> dirty;
+  Policy policy;
+  CacheStats counters;
+
+public:
+  explicit SetAssociativeCache(const CacheConfig& config)
+      : split(config), ways(config.ways), keys(static_cast<size_t>(config.num_blocks), 0),
+        dirty(config.sets(), 0), policy(config.sets(), config.ways)
+  {
+    if (config.ways > 64 || config.tag_width > 31)
+    {
+      throw std::invalid_argument("at most 64 ways and a 31-bit tag");
+    }
+  }
+
+  AccessResult access(uint32_t address, bool write)
+  {
+    uint32_t set = split.index(address);
+    uint32_t key = (split.tag(address) << 1) | 1;
+    uint32_t* row = &keys[static_cast<size_t>(set) * ways];
+    uint64_t hits = match_ways(row, ways, key);
+    AccessResult result{hits != 0, false, 0};
+
+    counters.reads += !write;
+    counters.writes += write;
+    if (result.hit)
+    {
+      result.way = static_cast<uint32_t>(__builtin_ctzll(hits));
+      counters.read_hits += !write;
+      counters.write_hits += write;
+      policy.touch(set, result.way);
+    }
+    else
+    {
+      uint64_t empty = match_ways(row, ways, 0);
+      result.way = empty ? static_cast<uint32_t>(__builtin_ctzll(empty)) : policy.victim(set);
+      result.write_back = (dirty[set] >> result.way) & 1;
+      counters.write_backs += result.write_back;
+      row[result.way] = key;
+      dirty[set] &= ~(1ull << result.way);
+      policy.fill(set, result.way);
+    }
+    dirty[set] |= static_cast<uint64_t>(write) << result.way;
+    return result;
+  }
+
+  void replay(const uint32_t* trace, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      access(trace_address(trace[i]), trace_is_write(trace[i]));
+    }
+  }
+
+  const CacheStats& stats() const
+  {
+    return counters;
+  }
+  const AddressSplit& address_split() const
+  {
+    return split;
+  }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "cache.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+bool is_power_of_two(uint32_t value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+uint32_t log2_exact(uint32_t value)
+{
+  return static_cast<uint32_t>(__builtin_ctz(value));
+}
+} // namespace
+
+AddressSplit::AddressSplit(const CacheConfig& config)
+{
+  if (!is_power_of_two(config.num_blocks) || !is_power_of_two(config.block_bytes) ||
+      !is_power_of_two(config.ways) || config.ways > config.num_blocks)
+  {
+    throw std::invalid_argument("num_blocks, ways and block_bytes must be powers of two");
+  }
+  offset_bits = log2_exact(config.block_bytes);
+  index_bits = log2_exact(config.sets());
+  if (config.tag_width == 0 || offset_bits + index_bits + config.tag_width > 32)
+  {
+    throw std::invalid_argument("tag + index + offset must fit in a 32-bit address");
+  }
+  tag_bits = config.tag_width;
+  index_mask = config.sets() - 1;
+  tag_mask = tag_bits == 32 ? ~0u : (1u << tag_bits) - 1;
+}
+
+DirectMappedCache::DirectMappedCache(const CacheConfig& config)
+    : split(config), lines(config.num_blocks, 0)
+{
+  // The tag is stored above two flag bits.
+  if (config.tag_width > 30)
+  {
+    throw std::invalid_argument("tag_width must be at most 30");
+  }
+  if (config.ways != 1)
+  {
+    throw std::invalid_argument("DirectMappedCache needs ways = 1");
+  }
+}
+
+void DirectMappedCache::reset()
+{
+  std::fill(lines.begin(), lines.end(), 0);
+  counters = CacheStats{};
+}
+
+void DirectMappedCache::replay(const uint32_t* trace, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    access(trace_address(trace[i]), trace_is_write(trace[i]));
+  }
+}
@@ -0,0 +1,139 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Geometry of the direct-mapped cache in Verilog/Cache/Cache.v, generalised.
+// An address splits (high to low) into tag | set index | offset within the block, with
+// num_blocks / ways sets.
+// Cache.v itself is num_blocks = 4, ways = 1, tag_width = 4, block_bytes = 16 (four 32-bit words):
+// a 10-bit address with tag [9:6], index [5:4], word [3:2], byte [1:0].
+// Verilog/TLB/associative_back_cache.v is num_blocks = 4, ways = 2, tag_width = 5: tag [9:5],
+// set [4].
+struct CacheConfig
+{
+  uint32_t num_blocks = 4;
+  uint32_t tag_width = 4;
+  uint32_t block_bytes = 16;
+  uint32_t ways = 1;
+
+  uint32_t sets() const
+  {
+    return ways ? num_blocks / ways : 0;
+  }
+};
+
+class AddressSplit
+{
+private:
+  uint32_t offset_bits;
+  uint32_t index_bits;
+  uint32_t tag_bits;
+  uint32_t index_mask;
+  uint32_t tag_mask;
+
+public:
+  explicit AddressSplit(const CacheConfig& config);
+
+  uint32_t address_bits() const
+  {
+    return offset_bits + index_bits + tag_bits;
+  }
+  uint32_t index(uint32_t address) const
+  {
+    return (address >> offset_bits) & index_mask;
+  }
+  uint32_t tag(uint32_t address) const
+  {
+    return (address >> (offset_bits + index_bits)) & tag_mask;
+  }
+  uint32_t offset(uint32_t address) const
+  {
+    return address & ((1u << offset_bits) - 1);
+  }
+  // First byte address of the block holding (tag, index).
+  uint32_t block_address(uint32_t tag, uint32_t index) const
+  {
+    return ((tag << index_bits) | index) << offset_bits;
+  }
+};
+
+struct CacheStats
+{
+  uint64_t reads = 0;
+  uint64_t writes = 0;
+  uint64_t read_hits = 0;
+  uint64_t write_hits = 0;
+  uint64_t write_backs = 0;
+
+  uint64_t accesses() const
+  {
+    return reads + writes;
+  }
+  uint64_t hits() const
+  {
+    return read_hits + write_hits;
+  }
+  uint64_t misses() const
+  {
+    return accesses() - hits();
+  }
+  double miss_ratio() const
+  {
+    return accesses() ? static_cast<double>(misses()) / accesses() : 0.0;
+  }
+};
+
+// Functional model of Cache.v: direct-mapped, write-back, write-allocate.
+// - read miss: write back the victim if dirty, fill, line becomes valid and clean
+// - write miss: write back the victim if dirty, fill, then write; line becomes valid and dirty
+// - write hit: line becomes dirty
+// Only metadata is tracked, packed into one word per line as (tag << 2) | dirty << 1 | valid, so a
+// lookup is a load and a compare.
+class DirectMappedCache
+{
+private:
+  static constexpr uint32_t kValid = 1;
+  static constexpr uint32_t kDirty = 2;
+
+  AddressSplit split;
+  std::vector<uint32_t> lines;
+  CacheStats counters;
+
+public:
+  explicit DirectMappedCache(const CacheConfig& config);
+
+  // Returns true on a hit. Written without data-dependent branches: on random traces hit/miss is
+  // unpredictable and mispredictions would otherwise dominate replay time.
+  bool access(uint32_t address, bool write)
+  {
+    uint32_t& line = lines[split.index(address)];
+    uint32_t want = (split.tag(address) << 2) | kValid;
+    uint32_t dirty = write ? kDirty : 0;
+    bool hit = (line & ~kDirty) == want;
+
+    counters.reads += !write;
+    counters.writes += write;
+    counters.read_hits += hit & !write;
+    counters.write_hits += hit & write;
+    counters.write_backs += !hit & ((line & kDirty) != 0);
+    line = (hit ? line : want) | dirty;
+    return hit;
+  }
+
+  void replay(const uint32_t* trace, size_t count);
+
+  void reset();
+  const CacheStats& stats() const
+  {
+    return counters;
+  }
+  const AddressSplit& address_split() const
+  {
+    return split;
+  }
+};
+
+#endif
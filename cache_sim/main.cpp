@@ -0,0 +1,267 @@
+#include "assoc_cache.hpp"
+#include "cache.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+// The 12 requests Verilog/Cache/CPU.v drives through Cache.v, with the outcome its comments
+// expect for each one.
+struct CpuRequest
+{
+  bool write;
+  uint32_t address;
+  const char* expected;
+};
+
+const CpuRequest kCpuRequests[] = {
+    {true, 0b0110101000, "write miss"},            {false, 0b0110101000, "read hit"},
+    {true, 0b0110101000, "write hit"},             {false, 0b0110101000, "read hit"},
+    {false, 0b0100001000, "read miss"},            {false, 0b0100101000, "read miss + write back"},
+    {false, 0b0110101000, "read miss"},            {true, 0b0110101000, "write hit"},
+    {true, 0b0101101000, "write miss + write back"}, {false, 0b0101101000, "read hit"},
+    {false, 0b0110101000, "read miss + write back"}, {false, 0b0110101001, "read hit"},
+};
+
+void replay_cpu_requests()
+{
+  DirectMappedCache cache(CacheConfig{});
+  std::cout << "CPU.v request sequence on the Cache.v geometry:\n";
+  int index = 0;
+  for (const auto& request : kCpuRequests)
+  {
+    uint64_t write_backs = cache.stats().write_backs;
+    bool hit = cache.access(request.address, request.write);
+    std::string got = std::string(request.write ? "write " : "read ") + (hit ? "hit" : "miss") +
+                      (cache.stats().write_backs != write_backs ? " + write back" : "");
+    std::cout << "  request " << index++ << ": " << got
+              << (got == request.expected ? "" : "   <-- expected " + std::string(request.expected))
+              << '\n';
+  }
+}
+
+// The vm_test.v request sequence after translation through page_table.v (VPN -> PPN 0->1, 1->3,
+// 4->2, 7->1, 8->1, 10->1; VPN 2 faults and never reaches the cache), with the outcome
+// associative_back_cache.v produces for each. The testbench comment on request 10 says way 1 is
+// replaced, but the LRU bit points at way 0 after the hits in 8 and 9, and request 13 only hits
+// because way 1 survived. associative_back_cache.v's write-miss path into way 1 also updates
+// LRU[{set, 1}] instead of LRU[set]; no request in this sequence depends on that.
+struct VmRequest
+{
+  int number;
+  bool write;
+  uint32_t virtual_address;
+  const char* expected;
+};
+
+const VmRequest kVmRequests[] = {
+    {0, true, 0b000100'100'0'1000, "miss way 0"},
+    {1, true, 0b000000'100'1'1100, "miss way 0"},
+    {2, true, 0b000001'100'1'1000, "miss way 1"},
+    {3, true, 0b000000'100'1'0101, "hit way 0"},
+    {4, false, 0b000111'100'1'0101, "hit way 0"},
+    {5, false, 0b001000'110'1'0101, "miss way 1 + write back"},
+    {6, false, 0b000001'110'1'0100, "miss way 0 + write back"},
+    {7, true, 0b000111'100'1'0111, "miss way 1"},
+    {8, false, 0b000000'100'1'1000, "hit way 1"},
+    {9, false, 0b001010'100'1'0100, "hit way 1"},
+    {10, false, 0b000000'110'1'0100, "miss way 0"},
+    {11, false, 0b000100'100'0'1000, "hit way 0"},
+    {13, false, 0b000111'100'1'1100, "hit way 1"},
+};
+
+uint32_t vm_translate(uint32_t virtual_address)
+{
+  static const uint32_t kFrames[] = {1, 3, 0, 3, 2, 0, 0, 1, 1, 0, 1};
+  return (kFrames[virtual_address >> 8] << 8) | (virtual_address & 0xff);
+}
+
+void replay_vm_requests()
+{
+  CacheConfig config;
+  config.tag_width = 5;
+  config.ways = 2;
+  SetAssociativeCache<TreePlruPolicy> cache(config);
+  std::cout << "vm_test.v request sequence on the associative_back_cache.v geometry:\n";
+  for (const auto& request : kVmRequests)
+  {
+    AccessResult result = cache.access(vm_translate(request.virtual_address), request.write);
+    std::string got = std::string(result.hit ? "hit" : "miss") + " way " +
+                      std::to_string(result.way) + (result.write_back ? " + write back" : "");
+    std::cout << "  request " << request.number << ": " << got
+              << (got == request.expected ? "" : "   <-- expected " + std::string(request.expected))
+              << '\n';
+  }
+}
+
+void print_stats(const CacheStats& stats, double seconds)
+{
+  std::cout << "accesses:    " << stats.accesses() << " (" << stats.reads << " reads, "
+            << stats.writes << " writes)\n"
+            << "hits:        " << stats.hits() << " (" << stats.read_hits << " read, "
+            << stats.write_hits << " write)\n"
+            << "misses:      " << stats.misses() << " (miss ratio " << stats.miss_ratio() << ")\n"
+            << "write-backs: " << stats.write_backs << '\n'
+            << "replay:      " << seconds << " s, " << stats.accesses() / seconds / 1e6
+            << " M accesses/s\n";
+}
+
+template <typename Cache> void run(const CacheConfig& config, const std::vector<uint32_t>& trace)
+{
+  Cache cache(config);
+  auto start = std::chrono::high_resolution_clock::now();
+  cache.replay(trace.data(), trace.size());
+  auto end = std::chrono::high_resolution_clock::now();
+  print_stats(cache.stats(), std::chrono::duration<double>(end - start).count());
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--blocks N] [--tag-width T] [--block-bytes B] [--ways N]\n"
+               "       [--policy lru|plru|fifo|random]\n"
+               "       [--trace FILE | --synthetic seq|stride|random|hot [--count N] [--writes PCT]"
+               " [--stride BYTES]]\n"
+               "       [--save FILE]\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CacheConfig config;
+  std::string trace_path;
+  std::string save_path;
+  std::string kind = "hot";
+  std::string policy = "lru";
+  size_t count = 100000000;
+  uint32_t writes = 25;
+  uint32_t stride = 64;
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--blocks")
+      {
+        config.num_blocks = std::stoul(value);
+      }
+      else if (arg == "--tag-width")
+      {
+        config.tag_width = std::stoul(value);
+      }
+      else if (arg == "--block-bytes")
+      {
+        config.block_bytes = std::stoul(value);
+      }
+      else if (arg == "--ways")
+      {
+        config.ways = std::stoul(value);
+      }
+      else if (arg == "--policy")
+      {
+        policy = value;
+      }
+      else if (arg == "--trace")
+      {
+        trace_path = value;
+      }
+      else if (arg == "--synthetic")
+      {
+        kind = value;
+      }
+      else if (arg == "--count")
+      {
+        count = std::stoull(value);
+      }
+      else if (arg == "--writes")
+      {
+        writes = std::stoul(value);
+      }
+      else if (arg == "--stride")
+      {
+        stride = std::stoul(value);
+      }
+      else if (arg == "--save")
+      {
+        save_path = value;
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    replay_cpu_requests();
+    replay_vm_requests();
+
+    AddressSplit split(config);
+    std::vector<uint32_t> trace =
+        trace_path.empty()
+            ? synthetic_trace(kind, count, std::min(split.address_bits(), 31u), writes, stride)
+            : load_trace(trace_path);
+    if (!save_path.empty())
+    {
+      save_trace(save_path, trace);
+    }
+
+    std::cout << "\n" << config.num_blocks << " blocks x " << config.block_bytes << " bytes, "
+              << config.ways << "-way" << (config.ways > 1 ? " " + policy : "") << ", tag width "
+              << config.tag_width << ", "
+              << (trace_path.empty() ? kind + " synthetic trace" : trace_path) << ":\n";
+    if (config.ways == 1)
+    {
+      run<DirectMappedCache>(config, trace);
+    }
+    else if (policy == "lru")
+    {
+      run<SetAssociativeCache<LruPolicy>>(config, trace);
+    }
+    else if (policy == "plru")
+    {
+      run<SetAssociativeCache<TreePlruPolicy>>(config, trace);
+    }
+    else if (policy == "fifo")
+    {
+      run<SetAssociativeCache<FifoPolicy>>(config, trace);
+    }
+    else if (policy == "random")
+    {
+      run<SetAssociativeCache<RandomPolicy>>(config, trace);
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
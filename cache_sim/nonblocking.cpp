@@ -0,0 +1,150 @@
+#include "nonblocking.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+NonBlockingCache::NonBlockingCache(const NonBlockingConfig& config)
+    : config(config), tags(config.cache), fills(config.cache.num_blocks), entries(config.mshrs),
+      words_per_block(0), transfer_cycles(0)
+{
+  if (config.mshrs == 0 || config.targets == 0 || config.bytes_per_cycle == 0)
+  {
+    throw std::invalid_argument("mshrs, targets and bytes_per_cycle must be positive");
+  }
+  if (config.word_bytes == 0 || config.cache.block_bytes % config.word_bytes != 0)
+  {
+    throw std::invalid_argument("block_bytes must be a multiple of word_bytes");
+  }
+  words_per_block = config.cache.block_bytes / config.word_bytes;
+  transfer_cycles = (config.cache.block_bytes + config.bytes_per_cycle - 1) / config.bytes_per_cycle;
+}
+
+// Cycle the given word of a refill reaches the cache.
+uint64_t NonBlockingCache::arrival(const Fill& fill, uint32_t word) const
+{
+  if (!config.critical_word_first)
+  {
+    return fill.end;
+  }
+  uint32_t position = (word + words_per_block - fill.critical_word) % words_per_block;
+  uint64_t bytes = static_cast<uint64_t>(position + 1) * config.word_bytes;
+  return fill.start + (bytes + config.bytes_per_cycle - 1) / config.bytes_per_cycle;
+}
+
+// Reserves the channel for one block, no earlier than `earliest`; returns the first bus cycle.
+uint64_t NonBlockingCache::transfer(uint64_t earliest)
+{
+  uint64_t start = std::max(earliest, bus_free);
+  bus_free = start + transfer_cycles;
+  counters.bus_cycles += transfer_cycles;
+  return start;
+}
+
+void NonBlockingCache::access(uint32_t address, bool write)
+{
+  const AddressSplit& split = tags.address_split();
+  uint32_t set = split.index(address);
+  uint32_t word = split.offset(address) / config.word_bytes;
+  AccessResult result = tags.access(address, write);
+  Fill& fill = fills[static_cast<size_t>(set) * config.cache.ways + result.way];
+  uint64_t ready;
+
+  ++counters.accesses;
+  // Blocking, every refill has completed before the next access issues, so nothing merges.
+  if (result.hit && (fill.end <= now || config.blocking))
+  {
+    ++counters.hits;
+    ready = now + config.hit_cycles;
+  }
+  else if (result.hit)
+  {
+    Mshr& mshr = entries[fill.mshr];
+    if (mshr.targets >= config.targets)
+    {
+      counters.target_stall_cycles += fill.end - now;
+      now = fill.end;
+      ++counters.hits;
+      ready = now + config.hit_cycles;
+    }
+    else
+    {
+      ++mshr.targets;
+      ++counters.secondary_misses;
+      ready = std::max(arrival(fill, word), now) + config.hit_cycles;
+    }
+  }
+  else
+  {
+    uint32_t free = 0;
+    for (uint32_t i = 1; i < config.mshrs; ++i)
+    {
+      free = entries[i].release < entries[free].release ? i : free;
+    }
+    if (entries[free].release > now)
+    {
+      counters.mshr_stall_cycles += entries[free].release - now;
+      now = entries[free].release;
+    }
+
+    ++counters.primary_misses;
+    counters.write_backs += result.write_back;
+    // Cache.v streams the dirty victim out before fetching; with MSHRs the victim waits in a
+    // write-back buffer and the refill goes first.
+    if (result.write_back && config.blocking)
+    {
+      transfer(now);
+    }
+    fill.start = transfer(now + config.memory_latency);
+    fill.end = fill.start + transfer_cycles;
+    fill.critical_word = config.critical_word_first ? word : 0;
+    fill.mshr = free;
+    entries[free] = {fill.end, 1};
+    if (result.write_back && !config.blocking)
+    {
+      transfer(now);
+    }
+
+    counters.miss_cycles += fill.end - now;
+    if (now >= busy_until)
+    {
+      counters.outstanding_cycles += fill.end - now;
+    }
+    else if (fill.end > busy_until)
+    {
+      counters.outstanding_cycles += fill.end - busy_until;
+    }
+    busy_until = std::max(busy_until, fill.end);
+    last_completion = std::max(last_completion, fill.end);
+    // Cache.v holds the processor until the whole block is in, critical word or not.
+    ready = (config.blocking ? fill.end : arrival(fill, word)) + config.hit_cycles;
+  }
+
+  uint64_t latency = ready - now;
+  counters.latency_cycles += latency;
+  last_completion = std::max(last_completion, ready);
+  if (config.blocking)
+  {
+    counters.miss_stall_cycles += latency - 1;
+    now = ready;
+  }
+  else
+  {
+    ++now;
+  }
+}
+
+void NonBlockingCache::replay(const uint32_t* trace, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    access(trace_address(trace[i]), trace_is_write(trace[i]));
+  }
+}
+
+NonBlockingStats NonBlockingCache::stats() const
+{
+  NonBlockingStats result = counters;
+  result.cycles = std::max(now, last_completion);
+  return result;
+}
@@ -0,0 +1,126 @@
+#ifndef NONBLOCKING_HPP
+#define NONBLOCKING_HPP
+
+#include "assoc_cache.hpp"
+#include "cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cycle-approximate timing for a write-back, write-allocate cache in front of a pipelined memory
+// channel. Cache.v is the blocking corner of this space: every miss stalls the processor while
+// the block streams in word by word (and a dirty victim streams out first). Here misses allocate
+// miss status holding registers (MSHRs) instead, so the processor keeps issuing:
+// - hit-under-miss: hits to resident lines complete while misses are outstanding
+// - miss-under-miss: up to `mshrs` blocks in flight; further misses to an in-flight block merge
+//   into its MSHR (up to `targets` accesses) instead of going to memory again
+// - critical-word-first: the refill starts at the requested word and wraps around (ignored when
+//   blocking, which waits for the whole block as Cache.v does)
+// The processor issues at most one access per cycle and accesses are independent of each other,
+// so with MSHRs it only stops issuing for a free MSHR or target slot; blocking, it stops until
+// each access has its data. Either way an access's latency runs from issue until its line is
+// ready, for loads and stores alike.
+struct NonBlockingConfig
+{
+  CacheConfig cache{512, 18, 64, 4};
+  uint32_t mshrs = 8;
+  uint32_t targets = 16;
+  bool blocking = false;
+  bool critical_word_first = true;
+  uint32_t hit_cycles = 1;
+  uint32_t memory_latency = 100; // request to first byte on the bus
+  uint32_t bytes_per_cycle = 16; // channel bandwidth, shared by refills and write-backs
+  uint32_t word_bytes = 4;
+};
+
+struct NonBlockingStats
+{
+  uint64_t accesses = 0;
+  uint64_t hits = 0;
+  uint64_t primary_misses = 0;   // went to memory
+  uint64_t secondary_misses = 0; // merged into an in-flight MSHR
+  uint64_t write_backs = 0;
+  uint64_t latency_cycles = 0;     // issue to data, summed over accesses
+  uint64_t mshr_stall_cycles = 0;  // no MSHR free
+  uint64_t target_stall_cycles = 0; // in-flight MSHR has no target slot left
+  uint64_t miss_stall_cycles = 0;  // blocking: waiting on an access beyond its issue cycle
+  uint64_t miss_cycles = 0;        // primary-miss lifetimes, summed
+  uint64_t outstanding_cycles = 0; // cycles with at least one primary miss in flight
+  uint64_t bus_cycles = 0;
+  uint64_t cycles = 0;
+
+  // Average memory access time, in cycles.
+  double amat() const
+  {
+    return accesses ? static_cast<double>(latency_cycles) / accesses : 0.0;
+  }
+  // Cycles the processor could not issue an access because of the cache.
+  uint64_t stall_cycles() const
+  {
+    return mshr_stall_cycles + target_stall_cycles + miss_stall_cycles;
+  }
+  // Memory-level parallelism: average misses in flight while any is.
+  double mlp() const
+  {
+    return outstanding_cycles ? static_cast<double>(miss_cycles) / outstanding_cycles : 0.0;
+  }
+  double miss_ratio() const
+  {
+    return accesses ? static_cast<double>(primary_misses) / accesses : 0.0;
+  }
+  double merge_ratio() const
+  {
+    return accesses ? static_cast<double>(secondary_misses) / accesses : 0.0;
+  }
+  double bus_utilisation() const
+  {
+    return cycles ? static_cast<double>(bus_cycles) / cycles : 0.0;
+  }
+};
+
+class NonBlockingCache
+{
+private:
+  struct Mshr
+  {
+    uint64_t release = 0; // cycle the whole block has arrived
+    uint32_t targets = 0;
+  };
+
+  // Per line: the refill that last brought it in.
+  struct Fill
+  {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t critical_word = 0;
+    uint32_t mshr = 0;
+  };
+
+  NonBlockingConfig config;
+  SetAssociativeCache<LruPolicy> tags;
+  std::vector<Fill> fills;
+  std::vector<Mshr> entries;
+  uint32_t words_per_block;
+  uint64_t transfer_cycles;
+  uint64_t now = 0;
+  uint64_t bus_free = 0;
+  uint64_t busy_until = 0; // end of the latest primary miss, for outstanding_cycles
+  uint64_t last_completion = 0;
+  NonBlockingStats counters;
+
+  uint64_t arrival(const Fill& fill, uint32_t word) const;
+  uint64_t transfer(uint64_t earliest);
+
+public:
+  explicit NonBlockingCache(const NonBlockingConfig& config);
+
+  // Issues one access at the current cycle, stalling first if it needs an MSHR or target slot
+  // that is not free, and advances the clock to when the next access may issue.
+  void access(uint32_t address, bool write);
+  void replay(const uint32_t* trace, size_t count);
+
+  NonBlockingStats stats() const;
+};
+
+#endif
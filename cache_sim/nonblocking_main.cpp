@@ -0,0 +1,196 @@
+#include "nonblocking.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<uint32_t> parse_list(const std::string& list)
+{
+  std::vector<uint32_t> values;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ','))
+  {
+    if (!item.empty())
+    {
+      values.push_back(static_cast<uint32_t>(std::stoul(item)));
+    }
+  }
+  return values;
+}
+
+// One row per MSHR count; 0 stands for the blocking cache of Cache.v.
+void compare(const NonBlockingConfig& base,
+             const std::vector<uint32_t>& mshr_counts,
+             const std::vector<uint32_t>& trace,
+             const std::string& name)
+{
+  std::cout << '\n'
+            << name << ", " << base.cache.num_blocks << " x " << base.cache.block_bytes << "-byte "
+            << base.cache.ways << "-way, " << base.memory_latency << "-cycle memory at "
+            << base.bytes_per_cycle << " B/cycle"
+            << (base.critical_word_first ? ", critical word first" : "") << ":\n"
+            << "  mode         miss ratio  merged     AMAT     MLP  cycles/access  stall cycles"
+               "  bus use  M acc/s\n";
+  for (uint32_t mshrs : mshr_counts)
+  {
+    NonBlockingConfig config = base;
+    config.blocking = mshrs == 0;
+    config.mshrs = mshrs ? mshrs : 1;
+    NonBlockingCache cache(config);
+    auto start = std::chrono::high_resolution_clock::now();
+    cache.replay(trace.data(), trace.size());
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    NonBlockingStats stats = cache.stats();
+    std::string mode = mshrs == 0 ? "blocking" : std::to_string(mshrs) + " MSHRs";
+    std::cout << "  " << std::left << std::setw(11) << mode << std::right << std::fixed
+              << std::setprecision(4) << std::setw(12) << stats.miss_ratio() << std::setw(8)
+              << stats.merge_ratio() << std::setprecision(2) << std::setw(9) << stats.amat()
+              << std::setw(8) << stats.mlp() << std::setw(15)
+              << static_cast<double>(stats.cycles) / stats.accesses << std::setw(14)
+              << stats.stall_cycles() << std::setw(8)
+              << std::setprecision(0)
+              << stats.bus_utilisation() * 100 << '%' << std::setw(9) << std::setprecision(1)
+              << stats.accesses / seconds / 1e6 << std::defaultfloat << std::setprecision(6)
+              << '\n';
+  }
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--blocks N] [--block-bytes B] [--ways N] [--mshrs LIST] [--targets N]\n"
+               "       [--cwf 0|1] [--latency CYCLES] [--bandwidth BYTES_PER_CYCLE]\n"
+               "       [--trace FILE | --synthetic seq|stride|random|hot] [--count N]"
+               " [--writes PCT] [--address-bits B]\n"
+               "Without --trace/--synthetic, compares a streaming and a random trace."
+               " MSHR count 0 is the blocking cache.\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  NonBlockingConfig config;
+  std::vector<uint32_t> mshr_counts = {0, 1, 2, 4, 8, 16, 32};
+  std::string trace_path;
+  std::string kind;
+  size_t count = 10000000;
+  uint32_t writes = 25;
+  uint32_t address_bits = 26;
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--blocks")
+      {
+        config.cache.num_blocks = std::stoul(value);
+      }
+      else if (arg == "--block-bytes")
+      {
+        config.cache.block_bytes = std::stoul(value);
+      }
+      else if (arg == "--ways")
+      {
+        config.cache.ways = std::stoul(value);
+      }
+      else if (arg == "--mshrs")
+      {
+        mshr_counts = parse_list(value);
+      }
+      else if (arg == "--targets")
+      {
+        config.targets = std::stoul(value);
+      }
+      else if (arg == "--cwf")
+      {
+        config.critical_word_first = value != "0";
+      }
+      else if (arg == "--latency")
+      {
+        config.memory_latency = std::stoul(value);
+      }
+      else if (arg == "--bandwidth")
+      {
+        config.bytes_per_cycle = std::stoul(value);
+      }
+      else if (arg == "--trace")
+      {
+        trace_path = value;
+      }
+      else if (arg == "--synthetic")
+      {
+        kind = value;
+      }
+      else if (arg == "--count")
+      {
+        count = std::stoull(value);
+      }
+      else if (arg == "--writes")
+      {
+        writes = std::stoul(value);
+      }
+      else if (arg == "--address-bits")
+      {
+        address_bits = std::stoul(value);
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    // Let the tag take whatever the index and offset leave of a 31-bit trace address.
+    AddressSplit narrow({config.cache.num_blocks, 1, config.cache.block_bytes, config.cache.ways});
+    config.cache.tag_width = 32 - narrow.address_bits();
+
+    if (!trace_path.empty())
+    {
+      compare(config, mshr_counts, load_trace(trace_path), trace_path);
+    }
+    else if (!kind.empty())
+    {
+      compare(config, mshr_counts, synthetic_trace(kind, count, address_bits, writes),
+              kind + " synthetic trace");
+    }
+    else
+    {
+      compare(config, mshr_counts, synthetic_trace("seq", count, address_bits, writes),
+              "streaming (seq) trace");
+      compare(config, mshr_counts, synthetic_trace("random", count, address_bits, writes),
+              "random trace");
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
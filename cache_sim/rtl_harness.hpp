@@ -0,0 +1,93 @@
+#ifndef RTL_HARNESS_HPP
+#define RTL_HARNESS_HPP
+
+#include "verilated.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// Shared driver for the Verilated RTL (built with --timing). Cache.v and the Verilog/TLB modules
+// have no clock of their own: their always @(*) blocks run on #delays and the main-memory Done
+// handshake. The harness plays the processor of CPU.v / vm_test.v instead: it holds a request on
+// the ports and samples hit_miss on every rising edge of a 10 ns clock, and the first edge that
+// sees hit_miss completes the request.
+
+constexpr uint64_t kClockPeriodNs = 10;
+// Requests still waiting after this many cycles are reported as hung and end the run.
+constexpr uint64_t kRequestTimeoutCycles = 256;
+
+class RtlClock
+{
+private:
+  VerilatedContext& context;
+  uint64_t ticks_per_cycle = kClockPeriodNs;
+  uint64_t elapsed = 0;
+
+public:
+  explicit RtlClock(VerilatedContext& context) : context(context)
+  {
+    // Model time counts in the design's time precision (1ps for `timescale 1ns / 1ps).
+    for (int exponent = -9 - context.timeprecision(); exponent > 0; --exponent)
+    {
+      ticks_per_cycle *= 10;
+    }
+  }
+
+  // Runs every event the model has scheduled up to and including the next rising edge.
+  template <typename Model> void step(Model& model)
+  {
+    uint64_t edge = (elapsed + 1) * ticks_per_cycle;
+    model.eval();
+    while (model.eventsPending() && model.nextTimeSlot() <= edge)
+    {
+      context.time(model.nextTimeSlot());
+      model.eval();
+    }
+    context.time(edge);
+    model.eval();
+    ++elapsed;
+  }
+
+  uint64_t cycles() const
+  {
+    return elapsed;
+  }
+};
+
+struct RtlReport
+{
+  uint64_t requests = 0;
+  uint64_t faults = 0;
+  uint64_t reference_hits = 0;
+  uint64_t rtl_hits = 0; // completed on the first edge
+  uint64_t outcome_mismatches = 0;
+  uint64_t data_mismatches = 0;
+  uint64_t cycles = 0;
+  bool hung = false;
+
+  bool passed() const
+  {
+    return !hung && data_mismatches == 0;
+  }
+};
+
+inline void print_report(const RtlReport& report, double seconds)
+{
+  std::cout << "requests:    " << report.requests << " (" << report.faults << " page faults)\n"
+            << "hits:        " << report.rtl_hits << " RTL, " << report.reference_hits
+            << " reference (" << report.outcome_mismatches << " requests disagree)\n"
+            << "data:        " << report.data_mismatches << " mismatched reads\n"
+            << "simulated:   " << report.cycles << " cycles in " << seconds << " s, "
+            << report.cycles / seconds / 1e6 << " M cycles/s, " << report.requests / seconds / 1e6
+            << " M requests/s\n"
+            << (report.passed() ? "PASS" : report.hung ? "FAIL (RTL hung)" : "FAIL") << '\n';
+}
+
+// Deterministic store data for request i of a trace, which carries addresses only.
+inline uint32_t rtl_write_data(size_t i)
+{
+  return static_cast<uint32_t>(i) * 2654435761u + 1;
+}
+
+#endif
@@ -0,0 +1,471 @@
+#include "assoc_cache.hpp"
+#include "cache.hpp"
+#include "trace.hpp"
+#include "vm.hpp"
+#include "work_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Design-space sweep: one trace, a grid of cache and TLB parameters, every configuration replayed
+// in parallel on a work-stealing pool. The trace is mapped once and shared read-only by all
+// workers; each configuration owns its model, so replays share nothing writable.
+
+namespace
+{
+struct CacheJob
+{
+  CacheConfig config;
+  std::string policy;
+  CacheStats stats;
+  double seconds = 0;
+};
+
+struct TlbJob
+{
+  VmConfig config;
+  VmStats stats;
+  double seconds = 0;
+};
+
+std::vector<std::string> split_list(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ','))
+  {
+    if (!item.empty())
+    {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+std::vector<uint32_t> parse_list(const std::string& list)
+{
+  std::vector<uint32_t> values;
+  for (const auto& item : split_list(list))
+  {
+    values.push_back(static_cast<uint32_t>(std::stoul(item)));
+  }
+  return values;
+}
+
+uint32_t log2_floor(uint32_t value)
+{
+  return value ? 31 - static_cast<uint32_t>(__builtin_clz(value)) : 0;
+}
+
+template <typename Cache> CacheStats replay(const CacheConfig& config, const MappedTrace& trace)
+{
+  Cache cache(config);
+  cache.replay(trace.data(), trace.size());
+  return cache.stats();
+}
+
+CacheStats replay_cache(const CacheConfig& config,
+                        const std::string& policy,
+                        const MappedTrace& trace)
+{
+  if (config.ways == 1)
+  {
+    return replay<DirectMappedCache>(config, trace);
+  }
+  if (policy == "lru")
+  {
+    return replay<SetAssociativeCache<LruPolicy>>(config, trace);
+  }
+  if (policy == "plru")
+  {
+    return replay<SetAssociativeCache<TreePlruPolicy>>(config, trace);
+  }
+  if (policy == "fifo")
+  {
+    return replay<SetAssociativeCache<FifoPolicy>>(config, trace);
+  }
+  if (policy == "random")
+  {
+    return replay<SetAssociativeCache<RandomPolicy>>(config, trace);
+  }
+  throw std::invalid_argument("unknown policy: " + policy);
+}
+
+std::string capacity_string(uint64_t bytes)
+{
+  if (bytes >= (1u << 20))
+  {
+    return std::to_string(bytes >> 20) + " MiB";
+  }
+  if (bytes >= (1u << 10))
+  {
+    return std::to_string(bytes >> 10) + " KiB";
+  }
+  return std::to_string(bytes) + " B";
+}
+
+std::string bar(double ratio)
+{
+  constexpr int kWidth = 50;
+  return std::string(static_cast<size_t>(std::clamp(ratio, 0.0, 1.0) * kWidth + 0.5), '#');
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--trace FILE | --synthetic seq|stride|random|hot [--count N] [--writes PCT]"
+               " [--stride BYTES]]\n"
+               "       [--address-bits B] [--blocks LIST] [--block-bytes LIST] [--ways LIST]"
+               " [--policy LIST]\n"
+               "       [--tlb-entries LIST] [--tlb-ways LIST] [--page-bits P] [--level-bits B]"
+               " [--pwc-entries N]\n"
+               "       [--threads N] [--csv FILE]\n"
+               "LIST is comma separated, e.g. --ways 1,2,4,8; an empty list skips that grid.\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string trace_path;
+  std::string kind = "hot";
+  std::string csv_path;
+  size_t count = 20000000;
+  uint32_t writes = 25;
+  uint32_t stride = 64;
+  uint32_t address_bits = 0;
+  std::vector<uint32_t> blocks = {64, 256, 1024, 4096, 16384};
+  std::vector<uint32_t> block_bytes = {64};
+  std::vector<uint32_t> ways = {1, 2, 4, 8};
+  std::vector<std::string> policies = {"lru"};
+  std::vector<uint32_t> tlb_entries = {16, 32, 64, 128, 256};
+  std::vector<uint32_t> tlb_ways = {4};
+  uint32_t page_bits = 12;
+  uint32_t level_bits = 9;
+  uint32_t pwc_entries = 0;
+  unsigned threads = std::thread::hardware_concurrency();
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--trace")
+      {
+        trace_path = value;
+      }
+      else if (arg == "--synthetic")
+      {
+        kind = value;
+      }
+      else if (arg == "--count")
+      {
+        count = std::stoull(value);
+      }
+      else if (arg == "--writes")
+      {
+        writes = std::stoul(value);
+      }
+      else if (arg == "--stride")
+      {
+        stride = std::stoul(value);
+      }
+      else if (arg == "--address-bits")
+      {
+        address_bits = std::stoul(value);
+      }
+      else if (arg == "--blocks")
+      {
+        blocks = parse_list(value);
+      }
+      else if (arg == "--block-bytes")
+      {
+        block_bytes = parse_list(value);
+      }
+      else if (arg == "--ways")
+      {
+        ways = parse_list(value);
+      }
+      else if (arg == "--policy")
+      {
+        policies = split_list(value);
+      }
+      else if (arg == "--tlb-entries")
+      {
+        tlb_entries = parse_list(value);
+      }
+      else if (arg == "--tlb-ways")
+      {
+        tlb_ways = parse_list(value);
+      }
+      else if (arg == "--page-bits")
+      {
+        page_bits = std::stoul(value);
+      }
+      else if (arg == "--level-bits")
+      {
+        level_bits = std::stoul(value);
+      }
+      else if (arg == "--pwc-entries")
+      {
+        pwc_entries = std::stoul(value);
+      }
+      else if (arg == "--threads")
+      {
+        threads = std::stoul(value);
+      }
+      else if (arg == "--csv")
+      {
+        csv_path = value;
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    std::unique_ptr<MappedTrace> trace;
+    if (trace_path.empty())
+    {
+      trace = std::make_unique<MappedTrace>(
+          synthetic_trace(kind, count, address_bits ? address_bits : 24, writes, stride));
+    }
+    else
+    {
+      trace = std::make_unique<MappedTrace>(trace_path);
+    }
+    if (!address_bits)
+    {
+      // Just wide enough for the highest address in the trace.
+      uint32_t highest = 0;
+      for (size_t i = 0; i < trace->size(); ++i)
+      {
+        highest |= trace_address(trace->data()[i]);
+      }
+      address_bits = std::max(log2_floor(highest) + 1, page_bits + 1);
+    }
+
+    // Cache grid. The tag takes whatever the set index and block offset leave of the address.
+    std::vector<CacheJob> cache_jobs;
+    size_t skipped = 0;
+    for (uint32_t bytes : block_bytes)
+    {
+      for (uint32_t way_count : ways)
+      {
+        for (const auto& policy : way_count == 1 ? std::vector<std::string>{"-"} : policies)
+        {
+          for (uint32_t block_count : blocks)
+          {
+            CacheJob job;
+            job.config.num_blocks = block_count;
+            job.config.block_bytes = bytes;
+            job.config.ways = way_count;
+            uint32_t used = log2_floor(bytes) + log2_floor(way_count ? block_count / way_count : 0);
+            job.config.tag_width = address_bits > used ? address_bits - used : 1;
+            job.policy = policy;
+            try
+            {
+              AddressSplit check(job.config);
+              cache_jobs.push_back(job);
+            }
+            catch (const std::invalid_argument&)
+            {
+              ++skipped;
+            }
+          }
+        }
+      }
+    }
+
+    // TLB grid over a demand-paged radix table covering the trace's address space.
+    std::vector<TlbJob> tlb_jobs;
+    for (uint32_t way_count : tlb_ways)
+    {
+      for (uint32_t entries : tlb_entries)
+      {
+        TlbJob job;
+        job.config.page_bits = page_bits;
+        job.config.level_bits = level_bits;
+        job.config.levels = (address_bits - page_bits + level_bits - 1) / level_bits;
+        job.config.tlb_entries = entries;
+        job.config.tlb_ways = way_count;
+        job.config.pwc_entries = pwc_entries;
+        job.config.demand_paging = true;
+        try
+        {
+          Mmu check(job.config);
+          tlb_jobs.push_back(job);
+        }
+        catch (const std::invalid_argument&)
+        {
+          ++skipped;
+        }
+      }
+    }
+
+    WorkStealingPool pool(threads);
+    std::vector<WorkStealingPool::Task> tasks;
+    for (auto& job : cache_jobs)
+    {
+      tasks.emplace_back([&job, &trace] {
+        auto start = std::chrono::high_resolution_clock::now();
+        job.stats = replay_cache(job.config, job.policy, *trace);
+        auto end = std::chrono::high_resolution_clock::now();
+        job.seconds = std::chrono::duration<double>(end - start).count();
+      });
+    }
+    for (auto& job : tlb_jobs)
+    {
+      tasks.emplace_back([&job, &trace] {
+        auto start = std::chrono::high_resolution_clock::now();
+        Mmu mmu(job.config);
+        mmu.replay(trace->data(), trace->size());
+        job.stats = mmu.stats();
+        auto end = std::chrono::high_resolution_clock::now();
+        job.seconds = std::chrono::duration<double>(end - start).count();
+      });
+    }
+
+    size_t configurations = tasks.size();
+    auto start = std::chrono::high_resolution_clock::now();
+    pool.run(std::move(tasks));
+    auto end = std::chrono::high_resolution_clock::now();
+    double wall = std::chrono::duration<double>(end - start).count();
+    double busy = 0;
+    for (const auto& job : cache_jobs)
+    {
+      busy += job.seconds;
+    }
+    for (const auto& job : tlb_jobs)
+    {
+      busy += job.seconds;
+    }
+
+    std::cout << trace->size() << " accesses over " << address_bits << " address bits ("
+              << (trace_path.empty() ? kind + " synthetic trace" : trace_path) << "), "
+              << configurations << " configurations";
+    if (skipped)
+    {
+      std::cout << " (" << skipped << " invalid skipped)";
+    }
+    std::cout << " on " << pool.threads() << " threads: " << wall << " s wall, " << busy
+              << " s of replay, " << pool.steals() << " steals\n";
+
+    std::ofstream csv;
+    if (!csv_path.empty())
+    {
+      csv.open(csv_path);
+      csv << "kind,blocks_or_entries,block_bytes_or_page_bytes,ways,policy,capacity_bytes,"
+             "accesses,miss_ratio,write_backs,avg_cycles\n";
+    }
+
+    if (!cache_jobs.empty())
+    {
+      std::cout << "\ncaches:\n"
+                << "  blocks  block  ways  policy  capacity   miss ratio  write-backs  M acc/s\n";
+      for (const auto& job : cache_jobs)
+      {
+        uint64_t capacity = static_cast<uint64_t>(job.config.num_blocks) * job.config.block_bytes;
+        std::cout << "  " << std::setw(6) << job.config.num_blocks << std::setw(7)
+                  << job.config.block_bytes << std::setw(6) << job.config.ways << std::setw(8)
+                  << job.policy << std::setw(10) << capacity_string(capacity) << std::setw(13)
+                  << std::fixed << std::setprecision(5) << job.stats.miss_ratio()
+                  << std::setw(13) << job.stats.write_backs << std::setw(9)
+                  << std::setprecision(1) << job.stats.accesses() / job.seconds / 1e6
+                  << std::defaultfloat << std::setprecision(6) << '\n';
+        if (csv.is_open())
+        {
+          csv << "cache," << job.config.num_blocks << ',' << job.config.block_bytes << ','
+              << job.config.ways << ',' << job.policy << ',' << capacity << ','
+              << job.stats.accesses() << ',' << job.stats.miss_ratio() << ','
+              << job.stats.write_backs << ",\n";
+        }
+      }
+
+      // Miss-ratio curves: one per (block size, associativity, policy), over capacity.
+      std::map<std::tuple<uint32_t, uint32_t, std::string>, std::vector<const CacheJob*>> curves;
+      for (const auto& job : cache_jobs)
+      {
+        curves[{job.config.block_bytes, job.config.ways, job.policy}].push_back(&job);
+      }
+      for (auto& [key, points] : curves)
+      {
+        std::sort(points.begin(), points.end(), [](const CacheJob* a, const CacheJob* b) {
+          return a->config.num_blocks < b->config.num_blocks;
+        });
+        std::cout << "\nmiss ratio, " << std::get<0>(key) << "-byte blocks, " << std::get<1>(key)
+                  << "-way" << (std::get<1>(key) > 1 ? " " + std::get<2>(key) : "") << ":\n";
+        for (const auto* job : points)
+        {
+          uint64_t capacity = static_cast<uint64_t>(job->config.num_blocks) * job->config.block_bytes;
+          std::cout << "  " << std::setw(8) << capacity_string(capacity) << "  " << std::fixed
+                    << std::setprecision(4) << job->stats.miss_ratio() << std::defaultfloat
+                    << std::setprecision(6) << "  " << bar(job->stats.miss_ratio()) << '\n';
+        }
+      }
+    }
+
+    if (!tlb_jobs.empty())
+    {
+      const VmConfig& geometry = tlb_jobs.front().config;
+      std::cout << "\nTLBs (" << (1u << geometry.page_bits) << "-byte pages, " << geometry.levels
+                << "-level table, " << geometry.pwc_entries << "-entry page-walk cache):\n"
+                << "  entries  ways  miss ratio  avg cycles  M acc/s\n";
+      for (const auto& job : tlb_jobs)
+      {
+        double miss_ratio = 1.0 - job.stats.hit_ratio();
+        std::cout << "  " << std::setw(7) << job.config.tlb_entries << std::setw(6)
+                  << job.config.tlb_ways << std::setw(12) << std::fixed << std::setprecision(5)
+                  << miss_ratio << std::setw(12) << std::setprecision(2)
+                  << job.stats.average_cycles() << std::setw(9) << std::setprecision(1)
+                  << job.stats.accesses / job.seconds / 1e6 << std::defaultfloat
+                  << std::setprecision(6) << "  " << bar(miss_ratio) << '\n';
+        if (csv.is_open())
+        {
+          csv << "tlb," << job.config.tlb_entries << ',' << (1u << job.config.page_bits) << ','
+              << job.config.tlb_ways << ",lru,"
+              << (static_cast<uint64_t>(job.config.tlb_entries) << job.config.page_bits) << ','
+              << job.stats.accesses << ',' << miss_ratio << ",," << job.stats.average_cycles()
+              << '\n';
+        }
+      }
+    }
+    if (csv.is_open() && !csv)
+    {
+      throw std::runtime_error("cannot write " + csv_path);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
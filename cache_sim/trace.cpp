@@ -0,0 +1,186 @@
+#include "trace.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+bool ends_with(const std::string& str, const std::string& suffix)
+{
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<uint32_t> load_text_trace(std::ifstream& in)
+{
+  std::vector<uint32_t> trace;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    auto comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line.resize(comment);
+    }
+    std::istringstream fields(line);
+    std::string op;
+    std::string address;
+    if (!(fields >> op >> address))
+    {
+      continue;
+    }
+    if (op != "r" && op != "w" && op != "R" && op != "W")
+    {
+      throw std::runtime_error("bad trace op: " + op);
+    }
+    trace.push_back(
+        trace_record(static_cast<uint32_t>(std::stoul(address, nullptr, 0)), op == "w" || op == "W"));
+  }
+  return trace;
+}
+} // namespace
+
+std::vector<uint32_t> load_trace(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+  {
+    throw std::runtime_error("cannot open trace " + path);
+  }
+  if (ends_with(path, ".txt"))
+  {
+    return load_text_trace(in);
+  }
+
+  in.seekg(0, std::ios::end);
+  auto bytes = static_cast<size_t>(in.tellg());
+  in.seekg(0, std::ios::beg);
+  std::vector<uint32_t> trace(bytes / sizeof(uint32_t));
+  in.read(reinterpret_cast<char*>(trace.data()), trace.size() * sizeof(uint32_t));
+  return trace;
+}
+
+void save_trace(const std::string& path, const std::vector<uint32_t>& trace)
+{
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(trace.data()), trace.size() * sizeof(uint32_t));
+  if (!out)
+  {
+    throw std::runtime_error("cannot write trace " + path);
+  }
+}
+
+MappedTrace::MappedTrace(const std::string& path)
+{
+  if (ends_with(path, ".txt"))
+  {
+    owned = load_trace(path);
+    records = owned.data();
+    count = owned.size();
+    return;
+  }
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    throw std::system_error(errno, std::generic_category(), "cannot open trace " + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) < 0)
+  {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "cannot stat trace " + path);
+  }
+  count = static_cast<size_t>(info.st_size) / sizeof(uint32_t);
+  if (count)
+  {
+    mapping_bytes = count * sizeof(uint32_t);
+    mapping = ::mmap(nullptr, mapping_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "cannot map trace " + path);
+    }
+    // Every replay streams the whole file front to back.
+    ::madvise(mapping, mapping_bytes, MADV_SEQUENTIAL);
+    ::madvise(mapping, mapping_bytes, MADV_WILLNEED);
+    records = static_cast<const uint32_t*>(mapping);
+  }
+  // The mapping keeps the file alive.
+  ::close(fd);
+}
+
+MappedTrace::MappedTrace(std::vector<uint32_t> trace) : owned(std::move(trace))
+{
+  records = owned.data();
+  count = owned.size();
+}
+
+MappedTrace::~MappedTrace()
+{
+  if (mapping)
+  {
+    ::munmap(mapping, mapping_bytes);
+  }
+}
+
+std::vector<uint32_t> synthetic_trace(const std::string& kind,
+                                      size_t count,
+                                      uint32_t address_bits,
+                                      uint32_t write_percent,
+                                      uint32_t stride,
+                                      uint32_t seed)
+{
+  if (address_bits == 0 || address_bits > 31)
+  {
+    throw std::invalid_argument("address_bits must be 1..31");
+  }
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<uint32_t> percent(0, 99);
+  uint32_t space = 1u << address_bits;
+  uint32_t mask = space - 1;
+  uint32_t hot = space >> 4 ? space >> 4 : 1;
+
+  std::vector<uint32_t> trace(count);
+  uint32_t cursor = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint32_t address;
+    if (kind == "seq")
+    {
+      address = cursor;
+      cursor += 4;
+    }
+    else if (kind == "stride")
+    {
+      address = cursor;
+      cursor += stride;
+    }
+    else if (kind == "random")
+    {
+      address = gen();
+    }
+    else if (kind == "hot")
+    {
+      address = percent(gen) < 90 ? gen() % hot : gen();
+    }
+    else
+    {
+      throw std::invalid_argument("unknown trace kind: " + kind);
+    }
+    trace[i] = trace_record(address & mask & ~3u, percent(gen) < write_percent);
+  }
+  return trace;
+}
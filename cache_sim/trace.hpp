@@ -0,0 +1,73 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A trace is a flat array of 32-bit records: bit 31 is the write flag, bits 30..0 the byte
+// address. Binary trace files are exactly that array in native byte order; text traces hold one
+// "r <addr>" / "w <addr>" per line (addresses in any base strtoul accepts, '#' starts a comment).
+constexpr uint32_t kTraceWrite = 1u << 31;
+
+inline uint32_t trace_record(uint32_t address, bool write)
+{
+  return (address & ~kTraceWrite) | (write ? kTraceWrite : 0);
+}
+inline uint32_t trace_address(uint32_t record)
+{
+  return record & ~kTraceWrite;
+}
+inline bool trace_is_write(uint32_t record)
+{
+  return (record & kTraceWrite) != 0;
+}
+
+// Loads a text trace if the path ends in ".txt", a binary one otherwise. Throws on I/O errors.
+std::vector<uint32_t> load_trace(const std::string& path);
+void save_trace(const std::string& path, const std::vector<uint32_t>& trace);
+
+// Read-only view of a trace. Binary files are mmap'd rather than read, so any number of
+// concurrent replays share the one page-cache copy; text traces and in-memory traces are held in
+// an owned buffer.
+class MappedTrace
+{
+private:
+  const uint32_t* records = nullptr;
+  size_t count = 0;
+  void* mapping = nullptr;
+  size_t mapping_bytes = 0;
+  std::vector<uint32_t> owned;
+
+public:
+  explicit MappedTrace(const std::string& path);
+  explicit MappedTrace(std::vector<uint32_t> trace);
+  ~MappedTrace();
+  MappedTrace(const MappedTrace&) = delete;
+  MappedTrace& operator=(const MappedTrace&) = delete;
+
+  const uint32_t* data() const
+  {
+    return records;
+  }
+  size_t size() const
+  {
+    return count;
+  }
+};
+
+// Synthetic access patterns over a 2^address_bits byte space:
+//   "seq"    - word-by-word sweep
+//   "stride" - jumps of `stride` bytes
+//   "random" - uniform word addresses
+//   "hot"    - 90% of accesses to a hot region 1/16th of the space, 10% uniform
+// write_percent of the accesses are writes.
+std::vector<uint32_t> synthetic_trace(const std::string& kind,
+                                      size_t count,
+                                      uint32_t address_bits,
+                                      uint32_t write_percent = 25,
+                                      uint32_t stride = 64,
+                                      uint32_t seed = 42);
+
+#endif
@@ -0,0 +1,208 @@
+#include "vm.hpp"
+#include "trace.hpp"
+
+#include <stdexcept>
+
+namespace
+{
+bool is_power_of_two(uint32_t value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+} // namespace
+
+PageTable::PageTable(const VmConfig& config)
+    : config(config), entries(static_cast<size_t>(1) << config.level_bits, 0)
+{
+  // Page numbers are stored above two flag bits in 32-bit TLB keys, and trace addresses are 31
+  // bits wide.
+  if (config.page_bits < 4 || config.level_bits == 0 || config.level_bits > 16 ||
+      config.levels == 0 || config.levels > 7 || config.virtual_bits() > 31)
+  {
+    throw std::invalid_argument("need page_bits >= 4, level_bits 1..16, levels 1..7 and a virtual "
+                                "address of at most 31 bits");
+  }
+  if (config.huge_percent > 100 || (config.huge_percent > 0 && config.levels < 2))
+  {
+    throw std::invalid_argument("huge pages need at least two levels and huge_percent <= 100");
+  }
+}
+
+// Walk down to the node at `level` covering address, creating inner nodes on the way.
+uint32_t PageTable::descend(uint32_t address, uint32_t level)
+{
+  uint32_t node = 0;
+  for (uint32_t depth = 0; depth < level; ++depth)
+  {
+    uint32_t index = (address >> shift(depth)) & ((1u << config.level_bits) - 1);
+    size_t slot = (static_cast<size_t>(node) << config.level_bits) + index;
+    if (entries[slot] & kHuge)
+    {
+      throw std::invalid_argument("address is already covered by a huge page");
+    }
+    if (!(entries[slot] & kValid))
+    {
+      // entries may reallocate here, so slot is re-indexed rather than held by reference
+      uint32_t child = static_cast<uint32_t>(nodes());
+      entries.resize(entries.size() + (static_cast<size_t>(1) << config.level_bits), 0);
+      entries[slot] = (child << 2) | kValid;
+    }
+    node = entries[slot] >> 2;
+  }
+  return node;
+}
+
+void PageTable::map(uint32_t address, uint32_t frame)
+{
+  uint32_t level = config.levels - 1;
+  uint32_t node = descend(address, level);
+  uint32_t index = (address >> shift(level)) & ((1u << config.level_bits) - 1);
+  entries[(static_cast<size_t>(node) << config.level_bits) + index] = (frame << 2) | kValid;
+}
+
+void PageTable::map_huge(uint32_t address, uint32_t frame)
+{
+  if (config.levels < 2)
+  {
+    throw std::invalid_argument("huge pages need at least two levels");
+  }
+  uint32_t level = config.levels - 2;
+  uint32_t node = descend(address, level);
+  uint32_t index = (address >> shift(level)) & ((1u << config.level_bits) - 1);
+  uint32_t& slot = entries[(static_cast<size_t>(node) << config.level_bits) + index];
+  if ((slot & kValid) && !(slot & kHuge))
+  {
+    throw std::invalid_argument("address is already covered by base pages");
+  }
+  slot = (frame << 2) | kHuge | kValid;
+  any_huge = true;
+}
+
+void PageTable::populate(uint32_t address)
+{
+  // Multiplicative hash of the region number, so the huge share is spread over the space rather
+  // than being its low end.
+  uint32_t region = address >> config.huge_bits();
+  bool huge = (region * 2654435761u >> 16) % 100 < config.huge_percent;
+  if (huge)
+  {
+    uint32_t span = 1u << config.level_bits;
+    next_frame = (next_frame + span - 1) & ~(span - 1);
+    map_huge(address, next_frame);
+    next_frame += span;
+  }
+  else
+  {
+    map(address, next_frame++);
+  }
+}
+
+Mmu::Mmu(const VmConfig& config)
+    : config(config), table(config),
+      tlb_set_mask(config.tlb_ways ? config.tlb_entries / config.tlb_ways - 1 : 0),
+      tlb_keys(config.tlb_entries, 0), tlb_frames(config.tlb_entries, 0),
+      tlb_policy(config.tlb_ways ? config.tlb_entries / config.tlb_ways : 0, config.tlb_ways),
+      pwc_keys(config.pwc_entries, 0), pwc_nodes(config.pwc_entries, 0),
+      pwc_policy(1, config.pwc_entries ? config.pwc_entries : 1)
+{
+  if (!is_power_of_two(config.tlb_entries) || !is_power_of_two(config.tlb_ways) ||
+      config.tlb_ways > config.tlb_entries || config.tlb_ways > 64)
+  {
+    throw std::invalid_argument("tlb_entries and tlb_ways must be powers of two, at most 64 ways");
+  }
+  if (config.pwc_entries > 64 || (config.pwc_entries && !is_power_of_two(config.pwc_entries)))
+  {
+    throw std::invalid_argument("pwc_entries must be 0 or a power of two up to 64");
+  }
+}
+
+void Mmu::tlb_fill(uint32_t number, uint32_t flags, uint32_t frame)
+{
+  uint32_t set = number & tlb_set_mask;
+  size_t row = static_cast<size_t>(set) * config.tlb_ways;
+  uint64_t empty = match_ways(&tlb_keys[row], config.tlb_ways, 0);
+  uint32_t way = empty ? static_cast<uint32_t>(__builtin_ctzll(empty)) : tlb_policy.victim(set);
+  tlb_keys[row + way] = (number << 2) | flags;
+  tlb_frames[row + way] = frame;
+  tlb_policy.fill(set, way);
+}
+
+void Mmu::pwc_fill(uint32_t key, uint32_t node)
+{
+  // Entries are never invalidated, so the free ones are always the tail.
+  uint32_t way = pwc_used < pwc_keys.size() ? pwc_used++ : pwc_policy.victim(0);
+  pwc_keys[way] = key;
+  pwc_nodes[way] = node;
+  pwc_policy.fill(0, way);
+}
+
+Translation Mmu::walk(uint32_t address)
+{
+  uint32_t entries = static_cast<uint32_t>(pwc_keys.size());
+  uint32_t level = 0;
+  uint32_t node = 0;
+  if (entries)
+  {
+    // All levels are probed at once; the deepest hit wins.
+    counters.cycles += config.pwc_cycles;
+    for (uint32_t deeper = config.levels - 1; deeper > 0; --deeper)
+    {
+      uint64_t hits = match_ways(pwc_keys.data(), entries, pwc_key(address, deeper));
+      if (hits)
+      {
+        uint32_t way = static_cast<uint32_t>(__builtin_ctzll(hits));
+        pwc_policy.touch(0, way);
+        ++counters.pwc_hits;
+        level = deeper;
+        node = pwc_nodes[way];
+        break;
+      }
+    }
+  }
+
+  while (true)
+  {
+    uint32_t entry = table.entry(node, address, level);
+    ++counters.walk_references;
+    counters.cycles += config.memory_cycles;
+    if (!(entry & PageTable::kValid))
+    {
+      ++counters.faults;
+      if (!config.demand_paging)
+      {
+        return {false, true, 0};
+      }
+      // The handler fills in the rest of the path; the walk resumes at the faulting level.
+      table.populate(address);
+      continue;
+    }
+    if (entry & PageTable::kHuge)
+    {
+      uint32_t frame = entry >> 2;
+      tlb_fill(address >> config.huge_bits(), PageTable::kHuge | PageTable::kValid, frame);
+      uint64_t offset = address & ((1u << config.huge_bits()) - 1);
+      return {false, false, (static_cast<uint64_t>(frame) << config.page_bits) | offset};
+    }
+    if (level == config.levels - 1)
+    {
+      uint32_t frame = entry >> 2;
+      tlb_fill(address >> config.page_bits, PageTable::kValid, frame);
+      uint64_t offset = address & ((1u << config.page_bits) - 1);
+      return {false, false, (static_cast<uint64_t>(frame) << config.page_bits) | offset};
+    }
+    node = entry >> 2;
+    ++level;
+    if (entries)
+    {
+      pwc_fill(pwc_key(address, level), node);
+    }
+  }
+}
+
+void Mmu::replay(const uint32_t* trace, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    translate(trace_address(trace[i]));
+  }
+}
@@ -0,0 +1,200 @@
+#ifndef VM_HPP
+#define VM_HPP
+
+#include "assoc_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Translation path of Verilog/TLB, generalised. A virtual address splits (high to low) into
+// `levels` page-table indices of level_bits each and a page offset of page_bits. The RTL is a
+// single 6-bit level over 256-byte pages (14-bit addresses) behind the 4-entry fully-associative
+// TLB of translation_look_aside_buffer.v. A huge page is a leaf one level early: it maps the
+// range a whole last-level table would, so its offset is page_bits + level_bits wide.
+struct VmConfig
+{
+  uint32_t page_bits = 8;
+  uint32_t levels = 1;
+  uint32_t level_bits = 6;
+  uint32_t tlb_entries = 4;
+  uint32_t tlb_ways = 4;
+  uint32_t pwc_entries = 0;   // page-walk cache of inner entries, 0 disables it
+  uint32_t huge_percent = 0;  // share of demand-mapped regions backed by one huge page
+  bool demand_paging = false; // map a page on its first fault instead of failing the access
+
+  // Cost model, in cycles.
+  uint32_t tlb_cycles = 1;
+  uint32_t pwc_cycles = 2;
+  uint32_t memory_cycles = 100; // per page-table entry read during a walk
+
+  uint32_t virtual_bits() const
+  {
+    return page_bits + levels * level_bits;
+  }
+  uint32_t huge_bits() const
+  {
+    return page_bits + level_bits;
+  }
+};
+
+struct VmStats
+{
+  uint64_t accesses = 0;
+  uint64_t tlb_hits = 0;
+  uint64_t huge_hits = 0;
+  uint64_t walk_references = 0;
+  uint64_t pwc_hits = 0;
+  uint64_t faults = 0;
+  uint64_t cycles = 0;
+
+  uint64_t walks() const
+  {
+    return accesses - tlb_hits;
+  }
+  double hit_ratio() const
+  {
+    return accesses ? static_cast<double>(tlb_hits) / accesses : 0.0;
+  }
+  double average_cycles() const
+  {
+    return accesses ? static_cast<double>(cycles) / accesses : 0.0;
+  }
+};
+
+// Radix page table, the multi-level form of page_table.v's page_directory. Nodes are
+// 2^level_bits entries carved out of one flat array, node 0 being the root. An entry is
+// (payload << 2) | huge << 1 | valid, where payload is the child node for inner entries and the
+// first physical frame (in base pages) for leaves.
+class PageTable
+{
+private:
+  VmConfig config;
+  std::vector<uint32_t> entries;
+  uint32_t next_frame = 0;
+  bool any_huge = false;
+
+  uint32_t descend(uint32_t address, uint32_t level);
+
+public:
+  static constexpr uint32_t kValid = 1;
+  static constexpr uint32_t kHuge = 2;
+
+  explicit PageTable(const VmConfig& config);
+
+  uint32_t shift(uint32_t level) const
+  {
+    return config.page_bits + (config.levels - 1 - level) * config.level_bits;
+  }
+  uint32_t entry(uint32_t node, uint32_t address, uint32_t level) const
+  {
+    uint32_t index = (address >> shift(level)) & ((1u << config.level_bits) - 1);
+    return entries[(static_cast<size_t>(node) << config.level_bits) + index];
+  }
+
+  // Map the base page / huge page holding address to frame. Throws if the range is already
+  // covered by a mapping of the other size.
+  void map(uint32_t address, uint32_t frame);
+  void map_huge(uint32_t address, uint32_t frame);
+  // Demand paging: map the page holding address to fresh frames, huge for the huge_percent share
+  // of regions.
+  void populate(uint32_t address);
+
+  bool has_huge_pages() const
+  {
+    return any_huge;
+  }
+  size_t nodes() const
+  {
+    return entries.size() >> config.level_bits;
+  }
+};
+
+struct Translation
+{
+  bool hit;
+  bool fault;
+  uint64_t physical_address;
+};
+
+// TLB, optional page-walk cache and page table. The TLB is set-associative with LRU replacement
+// (the usage_ranks of the RTL); base and huge pages share it, keyed as
+// (page number << 2) | huge << 1 | valid. The page-walk cache is fully associative over inner
+// entries, keyed by the address bits that select them: a hit lets the walk start at that level
+// instead of the root. It runs on every walk and can be 64 entries wide, so it uses tree-PLRU
+// rather than a linear scan for the victim.
+class Mmu
+{
+private:
+  VmConfig config;
+  PageTable table;
+  uint32_t tlb_set_mask;
+  std::vector<uint32_t> tlb_keys;
+  std::vector<uint32_t> tlb_frames;
+  LruPolicy tlb_policy;
+  std::vector<uint32_t> pwc_keys;
+  std::vector<uint32_t> pwc_nodes;
+  uint32_t pwc_used = 0;
+  TreePlruPolicy pwc_policy;
+  VmStats counters;
+
+  bool tlb_lookup(uint32_t number, uint32_t flags, uint32_t& frame)
+  {
+    uint32_t set = number & tlb_set_mask;
+    size_t row = static_cast<size_t>(set) * config.tlb_ways;
+    uint64_t hits = match_ways(&tlb_keys[row], config.tlb_ways, (number << 2) | flags);
+    if (!hits)
+    {
+      return false;
+    }
+    uint32_t way = static_cast<uint32_t>(__builtin_ctzll(hits));
+    tlb_policy.touch(set, way);
+    frame = tlb_frames[row + way];
+    return true;
+  }
+  void tlb_fill(uint32_t number, uint32_t flags, uint32_t frame);
+  uint32_t pwc_key(uint32_t address, uint32_t level) const
+  {
+    return ((address >> table.shift(level - 1)) << 4) | (level << 1) | 1;
+  }
+  void pwc_fill(uint32_t key, uint32_t node);
+  Translation walk(uint32_t address);
+
+public:
+  explicit Mmu(const VmConfig& config);
+
+  Translation translate(uint32_t address)
+  {
+    ++counters.accesses;
+    counters.cycles += config.tlb_cycles;
+    uint32_t frame = 0;
+    if (tlb_lookup(address >> config.page_bits, PageTable::kValid, frame))
+    {
+      ++counters.tlb_hits;
+      uint64_t offset = address & ((1u << config.page_bits) - 1);
+      return {true, false, (static_cast<uint64_t>(frame) << config.page_bits) | offset};
+    }
+    if (table.has_huge_pages() &&
+        tlb_lookup(address >> config.huge_bits(), PageTable::kHuge | PageTable::kValid, frame))
+    {
+      ++counters.tlb_hits;
+      ++counters.huge_hits;
+      uint64_t offset = address & ((1u << config.huge_bits()) - 1);
+      return {true, false, (static_cast<uint64_t>(frame) << config.page_bits) | offset};
+    }
+    return walk(address);
+  }
+
+  void replay(const uint32_t* trace, size_t count);
+
+  PageTable& page_table()
+  {
+    return table;
+  }
+  const VmStats& stats() const
+  {
+    return counters;
+  }
+};
+
+#endif
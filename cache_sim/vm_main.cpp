@@ -0,0 +1,197 @@
+#include "trace.hpp"
+#include "vm.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+// The vm_test.v request sequence on translation_look_aside_buffer.v and page_table.v, with the
+// TLB outcome and physical page the testbench comments give for each. The comment on request 13
+// says virtual page 10, but its address is in virtual page 7.
+struct TlbRequest
+{
+  uint32_t virtual_address;
+  const char* expected;
+};
+
+const TlbRequest kTlbRequests[] = {
+    {0b000100'100'0'1000, "miss, frame 2"}, {0b000000'100'1'1100, "miss, frame 1"},
+    {0b000001'100'1'1000, "miss, frame 3"}, {0b000000'100'1'0101, "hit, frame 1"},
+    {0b000111'100'1'0101, "miss, frame 1"}, {0b001000'110'1'0101, "miss, frame 1"},
+    {0b000001'110'1'0100, "hit, frame 3"},  {0b000111'100'1'0111, "hit, frame 1"},
+    {0b000000'100'1'1000, "hit, frame 1"},  {0b001010'100'1'0100, "miss, frame 1"},
+    {0b000000'110'1'0100, "hit, frame 1"},  {0b000100'100'0'1000, "miss, frame 2"},
+    {0b000010'110'1'0100, "page fault"},    {0b000111'100'1'1100, "hit, frame 1"},
+};
+
+// Valid entries of page_table.v's page_directory: {virtual page, physical page}.
+const uint32_t kPageDirectory[][2] = {{0, 1}, {1, 3}, {3, 3}, {4, 2}, {7, 1}, {8, 1}, {10, 1}};
+
+void replay_tlb_requests()
+{
+  VmConfig config;
+  Mmu mmu(config);
+  for (const auto& mapping : kPageDirectory)
+  {
+    mmu.page_table().map(mapping[0] << config.page_bits, mapping[1]);
+  }
+
+  std::cout << "vm_test.v request sequence on the translation_look_aside_buffer.v geometry:\n";
+  int index = 0;
+  for (const auto& request : kTlbRequests)
+  {
+    Translation result = mmu.translate(request.virtual_address);
+    std::string got = result.fault ? "page fault"
+                                   : std::string(result.hit ? "hit" : "miss") + ", frame " +
+                                         std::to_string(result.physical_address >> config.page_bits);
+    std::cout << "  request " << index++ << ": page " << (request.virtual_address >> config.page_bits)
+              << ' ' << got
+              << (got == request.expected ? "" : "   <-- expected " + std::string(request.expected))
+              << '\n';
+  }
+}
+
+void print_stats(const Mmu& mmu, double seconds)
+{
+  const VmStats& stats = mmu.stats();
+  std::cout << "accesses:      " << stats.accesses << '\n'
+            << "TLB hits:      " << stats.tlb_hits << " (hit ratio " << stats.hit_ratio() << ", "
+            << stats.huge_hits << " on huge pages)\n"
+            << "walks:         " << stats.walks() << " (" << stats.walk_references
+            << " page-table reads, " << stats.pwc_hits << " page-walk cache hits)\n"
+            << "faults:        " << stats.faults << '\n'
+            << "avg cost:      " << stats.average_cycles() << " cycles per translation\n"
+            << "replay:        " << seconds << " s, " << stats.accesses / seconds / 1e6
+            << " M translations/s\n";
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--page-bits P] [--levels L] [--level-bits B] [--huge-percent PCT]\n"
+               "       [--tlb-entries N] [--tlb-ways W] [--pwc-entries N] [--memory-cycles C]\n"
+               "       [--trace FILE | --synthetic seq|stride|random|hot [--count N]"
+               " [--stride BYTES]]\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // Defaults to a 4 KiB-page, two-level, 64-entry 4-way TLB setup; pages are mapped on first use.
+  VmConfig config;
+  config.page_bits = 12;
+  config.levels = 2;
+  config.level_bits = 9;
+  config.tlb_entries = 64;
+  config.tlb_ways = 4;
+  config.demand_paging = true;
+  std::string trace_path;
+  std::string kind = "hot";
+  size_t count = 100000000;
+  uint32_t stride = 4096;
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--page-bits")
+      {
+        config.page_bits = std::stoul(value);
+      }
+      else if (arg == "--levels")
+      {
+        config.levels = std::stoul(value);
+      }
+      else if (arg == "--level-bits")
+      {
+        config.level_bits = std::stoul(value);
+      }
+      else if (arg == "--huge-percent")
+      {
+        config.huge_percent = std::stoul(value);
+      }
+      else if (arg == "--tlb-entries")
+      {
+        config.tlb_entries = std::stoul(value);
+      }
+      else if (arg == "--tlb-ways")
+      {
+        config.tlb_ways = std::stoul(value);
+      }
+      else if (arg == "--pwc-entries")
+      {
+        config.pwc_entries = std::stoul(value);
+      }
+      else if (arg == "--memory-cycles")
+      {
+        config.memory_cycles = std::stoul(value);
+      }
+      else if (arg == "--trace")
+      {
+        trace_path = value;
+      }
+      else if (arg == "--synthetic")
+      {
+        kind = value;
+      }
+      else if (arg == "--count")
+      {
+        count = std::stoull(value);
+      }
+      else if (arg == "--stride")
+      {
+        stride = std::stoul(value);
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    replay_tlb_requests();
+
+    Mmu mmu(config);
+    std::vector<uint32_t> trace = trace_path.empty()
+                                      ? synthetic_trace(kind, count, config.virtual_bits(), 0, stride)
+                                      : load_trace(trace_path);
+
+    std::cout << "\n" << config.virtual_bits() << "-bit virtual space, " << config.levels
+              << " x " << config.level_bits << "-bit levels over " << (1u << config.page_bits)
+              << "-byte pages (" << config.huge_percent << "% huge), " << config.tlb_entries
+              << "-entry " << config.tlb_ways << "-way TLB, " << config.pwc_entries
+              << "-entry page-walk cache, "
+              << (trace_path.empty() ? kind + " synthetic trace" : trace_path) << ":\n";
+    auto start = std::chrono::high_resolution_clock::now();
+    mmu.replay(trace.data(), trace.size());
+    auto end = std::chrono::high_resolution_clock::now();
+    print_stats(mmu, std::chrono::duration<double>(end - start).count());
+    std::cout << "page table:    " << mmu.page_table().nodes() << " nodes\n";
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include "Vvm_top.h"
+#include "assoc_cache.hpp"
+#include "rtl_harness.hpp"
+#include "trace.hpp"
+#include "vm.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Streams a trace through the Verilated Verilog/TLB modules (Verilog/TLB/vm_top.v) and checks
+// every response against the C++ reference: Mmu over page_table.v's mappings for translation and
+// page faults, SetAssociativeCache for the cache outcome, and a flat copy of main_mem.v for data.
+// associative_back_cache.v stores whole words at byte offset 0 (sw/lw) and single bytes, zero
+// extended on reads, at any other offset (sb/lb).
+
+namespace
+{
+// Valid entries of page_table.v's page_directory: {virtual page, physical page}.
+const uint32_t kPageDirectory[][2] = {{0, 1}, {1, 3}, {3, 3}, {4, 2}, {7, 1}, {8, 1}, {10, 1}};
+
+// Non-zero blocks of main_mem.v's initial contents, word 0 first.
+struct MemoryBlock
+{
+  uint32_t block;
+  uint32_t words[4];
+};
+
+const MemoryBlock kMainMemory[] = {
+    {0, {0xA, 0xE, 0xF, 0x55555555}},
+    {4, {0xBBBBBBBB, 0xAAAAAAAA, 0xEEEEEEEE, 0xCCCCCCCC}},
+    {16, {0x11111111, 0x22222222, 0x33333333, 0x44444444}},
+    {20, {0x281, 0x285, 0x0, 0x28d}},
+    {21, {0x281, 0x285, 0x0, 0x28d}},
+    {25, {0x191, 0x195, 0x199, 0x191}},
+    {29, {0x1d1, 0x1d5, 0x1d9, 0x1dd}},
+    {33, {0x55555555, 0x66666666, 0x77777777, 0x88888888}},
+    {40, {0x281, 0x0, 0x285, 0x28d}},
+    {48, {0x55555555, 0x66666666, 0x77777777, 0x88888888}},
+    {49, {0x55555555, 0x66666666, 0x77777777, 0x88888888}},
+    {57, {0x391, 0x0, 0x395, 0x39d}},
+    {61, {0x3d1, 0x3d5, 0x3d9, 0x3dd}},
+};
+
+// Cycles to wait before sampling page_fault: TLB miss, page-table lookup and handshake.
+constexpr uint64_t kFaultCycles = 2;
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--trace FILE | --synthetic seq|stride|random|hot [--count N] [--writes PCT]]\n"
+               "       [--faults 0|1]\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  VerilatedContext context;
+  context.commandArgs(argc, argv);
+
+  std::string trace_path;
+  std::string kind = "random";
+  size_t count = 100000;
+  uint32_t writes = 25;
+  bool faults = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg[0] == '+')
+    {
+      continue; // +verilator+ options, consumed by commandArgs
+    }
+    if (i + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    std::string value = argv[++i];
+    if (arg == "--trace")
+    {
+      trace_path = value;
+    }
+    else if (arg == "--synthetic")
+    {
+      kind = value;
+    }
+    else if (arg == "--count")
+    {
+      count = std::stoull(value);
+    }
+    else if (arg == "--writes")
+    {
+      writes = std::stoul(value);
+    }
+    else if (arg == "--faults")
+    {
+      faults = value != "0";
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  try
+  {
+    VmConfig vm_config;
+    Mmu mmu(vm_config);
+    for (const auto& mapping : kPageDirectory)
+    {
+      mmu.page_table().map(mapping[0] << vm_config.page_bits, mapping[1]);
+    }
+    CacheConfig cache_config;
+    cache_config.tag_width = 5;
+    cache_config.ways = 2;
+    SetAssociativeCache<TreePlruPolicy> cache(cache_config);
+    std::vector<uint32_t> memory(1u << (cache.address_split().address_bits() - 2), 0);
+    for (const auto& block : kMainMemory)
+    {
+      for (uint32_t word = 0; word < 4; ++word)
+      {
+        memory[block.block * 4 + word] = block.words[word];
+      }
+    }
+
+    uint32_t virtual_bits = vm_config.virtual_bits();
+    std::vector<uint32_t> trace = trace_path.empty()
+                                      ? synthetic_trace(kind, count, virtual_bits, writes)
+                                      : load_trace(trace_path);
+    const uint32_t mapped_pages = sizeof(kPageDirectory) / sizeof(kPageDirectory[0]);
+
+    Vvm_top top{&context};
+    RtlClock clock(context);
+    RtlReport report;
+    // translation_look_aside_buffer.v and page_table.v initialise at #10.
+    clock.step(top);
+    clock.step(top);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < trace.size() && !report.hung; ++i)
+    {
+      uint32_t virtual_address = trace_address(trace[i]) & ((1u << virtual_bits) - 1);
+      if (trace_path.empty() && !faults)
+      {
+        // Fold synthetic pages onto mapped ones, or most requests would fault.
+        uint32_t page = kPageDirectory[(virtual_address >> vm_config.page_bits) % mapped_pages][0];
+        virtual_address =
+            (page << vm_config.page_bits) | (virtual_address & ((1u << vm_config.page_bits) - 1));
+      }
+      bool write = trace_is_write(trace[i]);
+      uint32_t data = rtl_write_data(i);
+      Translation translation = mmu.translate(virtual_address);
+
+      top.read_write = write;
+      top.virtual_address = virtual_address;
+      top.write_data_cache = data;
+      uint64_t issued = clock.cycles();
+      ++report.requests;
+
+      if (translation.fault)
+      {
+        // vm_test.v's notes: a faulting request is skipped and changes nothing.
+        for (uint64_t cycle = 0; cycle < kFaultCycles; ++cycle)
+        {
+          clock.step(top);
+        }
+        ++report.faults;
+        if (!top.page_fault)
+        {
+          std::cerr << "request " << i << " (" << virtual_address
+                    << ") should fault but page_fault is low\n";
+          ++report.data_mismatches;
+        }
+        continue;
+      }
+
+      do
+      {
+        clock.step(top);
+      } while (!top.hit_miss && clock.cycles() - issued < kRequestTimeoutCycles);
+      if (!top.hit_miss)
+      {
+        std::cerr << "request " << i << " (" << (write ? "write " : "read ") << virtual_address
+                  << ") never completed\n";
+        report.hung = true;
+        break;
+      }
+
+      uint32_t physical_address = static_cast<uint32_t>(translation.physical_address);
+      bool expect_hit = cache.access(physical_address, write).hit;
+      bool rtl_hit = clock.cycles() - issued == 1;
+      report.reference_hits += expect_hit;
+      report.rtl_hits += rtl_hit;
+      report.outcome_mismatches += rtl_hit != expect_hit;
+
+      uint32_t& word = memory[physical_address >> 2];
+      uint32_t byte = physical_address & 3;
+      uint32_t shift = 8 * byte;
+      if (write)
+      {
+        word = byte ? (word & ~(0xffu << shift)) | ((data & 0xff) << shift) : data;
+        continue;
+      }
+      uint32_t expected = byte ? (word >> shift) & 0xff : word;
+      if (top.read_data_cache != expected && report.data_mismatches++ < 10)
+      {
+        std::cerr << "request " << i << ": read " << virtual_address << " (physical "
+                  << physical_address << ") returned 0x" << std::hex << top.read_data_cache
+                  << ", expected 0x" << expected << std::dec << '\n';
+      }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    report.cycles = clock.cycles();
+    top.final();
+
+    std::cout << "Verilog/TLB, " << (trace_path.empty() ? kind + " synthetic trace" : trace_path)
+              << ":\n";
+    print_report(report, std::chrono::duration<double>(end - start).count());
+    return report.passed() ? 0 : 1;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+}
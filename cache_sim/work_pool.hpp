@@ -0,0 +1,122 @@
+#ifndef WORK_POOL_HPP
+#define WORK_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Runs a batch of independent tasks on a fixed set of threads. Tasks are dealt round-robin onto
+// one deque per worker; a worker pops its own deque from the back and, once that is empty,
+// steals from the front of the others, so whoever drew the cheap configurations keeps helping
+// with the expensive ones. Tasks are whole trace replays, so a mutex per deque is not a
+// measurable cost.
+class WorkStealingPool
+{
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(unsigned threads) : thread_count(threads ? threads : 1)
+  {
+  }
+
+  // Blocks until every task has run. The first exception thrown by a task is rethrown here,
+  // after the remaining tasks have finished.
+  void run(std::vector<Task> tasks)
+  {
+    std::vector<Queue> queues(thread_count);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+      queues[i % thread_count].tasks.push_back(std::move(tasks[i]));
+    }
+
+    std::exception_ptr failure;
+    std::mutex failure_lock;
+    auto worker = [&](unsigned self) {
+      Task task;
+      while (take(queues, self, task))
+      {
+        try
+        {
+          task();
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> guard(failure_lock);
+          if (!failure)
+          {
+            failure = std::current_exception();
+          }
+        }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < thread_count; ++i)
+    {
+      workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : workers)
+    {
+      thread.join();
+    }
+    if (failure)
+    {
+      std::rethrow_exception(failure);
+    }
+  }
+
+  unsigned threads() const
+  {
+    return thread_count;
+  }
+  size_t steals() const
+  {
+    return stolen.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  unsigned thread_count;
+  std::atomic<size_t> stolen{0};
+
+  // Tasks never spawn tasks, so one empty pass over every deque means the batch is drained.
+  bool take(std::vector<Queue>& queues, unsigned self, Task& task)
+  {
+    {
+      std::lock_guard<std::mutex> guard(queues[self].lock);
+      if (!queues[self].tasks.empty())
+      {
+        task = std::move(queues[self].tasks.back());
+        queues[self].tasks.pop_back();
+        return true;
+      }
+    }
+    for (unsigned offset = 1; offset < thread_count; ++offset)
+    {
+      Queue& victim = queues[(self + offset) % thread_count];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty())
+      {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Expression templates: arithmetic on expr_vectors does not compute anything, it builds a type
+// describing the computation, e.g. a + b * c - d is
+//   binary_expr<sub, binary_expr<add, expr_vector, binary_expr<mul, ...>>, expr_vector>
+// and only assigning it to an expr_vector runs one loop that evaluates the whole tree per
+// element. No temporary vectors, and the loop body is straight-line code the compiler can
+// vectorise. The same recursion-into-types idea as factorial in comp.hpp, applied to a tree.
+//
+// Expressions hold views of vectors and sub-expressions by value, so an expression must be
+// evaluated before the vectors it names go away; keep them out of `auto` variables that outlive
+// a statement.
+
+// CRTP base every expression derives from, which is what the operators match on.
+template <typename E> struct vec_expr
+{
+  const E& self() const
+  {
+    return static_cast<const E&>(*this);
+  }
+};
+
+template <typename T> class expr_vector : public vec_expr<expr_vector<T>>
+{
+private:
+  std::vector<T> data;
+
+  // The one loop, in blocks of kBlock elements plus a scalar tail. -O2's vectoriser will not add
+  // runtime overlap checks or remainder loops, so it needs a constant trip count and the ivdep
+  // promise that `out` does not overlap the operands in a way that matters. It does not: element
+  // i reads only element i of each operand, which also makes `a = a + b` correct.
+  static constexpr size_t kBlock = 32;
+
+  template <typename E> static void evaluate(T* out, size_t n, const E& e)
+  {
+    size_t i = 0;
+    for (; i + kBlock <= n; i += kBlock)
+    {
+#pragma GCC ivdep
+      for (size_t j = 0; j < kBlock; ++j)
+      {
+        out[i + j] = e[i + j];
+      }
+    }
+    for (; i < n; ++i)
+    {
+      out[i] = e[i];
+    }
+  }
+
+  template <typename E> void assign(const vec_expr<E>& expr)
+  {
+    evaluate(data.data(), data.size(), expr.self());
+  }
+
+public:
+  using value_type = T;
+
+  explicit expr_vector(size_t n, T value = T()) : data(n, value)
+  {
+  }
+
+  expr_vector(std::initializer_list<T> values) : data(values)
+  {
+  }
+
+  template <typename E> expr_vector(const vec_expr<E>& expr) : data(expr.self().size())
+  {
+    assign(expr);
+  }
+
+  // Element i of the result only reads element i of each operand, so `a = a + b` is safe.
+  template <typename E> expr_vector& operator=(const vec_expr<E>& expr)
+  {
+    if (expr.self().size() != data.size())
+    {
+      data.resize(expr.self().size());
+    }
+    assign(expr);
+    return *this;
+  }
+
+  T operator[](size_t i) const
+  {
+    return data[i];
+  }
+
+  T& operator[](size_t i)
+  {
+    return data[i];
+  }
+
+  size_t size() const
+  {
+    return data.size();
+  }
+
+  const T* raw() const
+  {
+    return data.data();
+  }
+
+  T* begin()
+  {
+    return data.data();
+  }
+
+  T* end()
+  {
+    return data.data() + data.size();
+  }
+};
+
+// A scalar operand, repeated for every element.
+template <typename T> class scalar_expr : public vec_expr<scalar_expr<T>>
+{
+private:
+  T value;
+  size_t n;
+
+public:
+  scalar_expr(T value, size_t n) : value(value), n(n)
+  {
+  }
+
+  T operator[](size_t) const
+  {
+    return value;
+  }
+
+  size_t size() const
+  {
+    return n;
+  }
+};
+
+namespace expr_detail
+{
+// A vector leaf as its data pointer, so the evaluation loop indexes a register rather than
+// reloading the std::vector's pointer every element.
+template <typename T> class leaf
+{
+private:
+  const T* data;
+  size_t n;
+
+public:
+  leaf(const expr_vector<T>& v) : data(v.raw()), n(v.size())
+  {
+  }
+
+  T operator[](size_t i) const
+  {
+    return data[i];
+  }
+
+  size_t size() const
+  {
+    return n;
+  }
+};
+
+// Leaves as views, inner nodes (temporaries of the full expression) by value.
+template <typename E> struct operand
+{
+  using type = E;
+};
+
+template <typename T> struct operand<expr_vector<T>>
+{
+  using type = leaf<T>;
+};
+
+struct add
+{
+  template <typename A, typename B> static auto apply(A a, B b)
+  {
+    return a + b;
+  }
+};
+
+struct sub
+{
+  template <typename A, typename B> static auto apply(A a, B b)
+  {
+    return a - b;
+  }
+};
+
+struct mul
+{
+  template <typename A, typename B> static auto apply(A a, B b)
+  {
+    return a * b;
+  }
+};
+
+struct div
+{
+  template <typename A, typename B> static auto apply(A a, B b)
+  {
+    return a / b;
+  }
+};
+} // namespace expr_detail
+
+template <typename Op, typename L, typename R>
+class binary_expr : public vec_expr<binary_expr<Op, L, R>>
+{
+private:
+  typename expr_detail::operand<L>::type left;
+  typename expr_detail::operand<R>::type right;
+
+public:
+  binary_expr(const L& left, const R& right) : left(left), right(right)
+  {
+    if (left.size() != right.size())
+    {
+      throw std::length_error("expr_vector operands differ in size");
+    }
+  }
+
+  auto operator[](size_t i) const
+  {
+    return Op::apply(left[i], right[i]);
+  }
+
+  size_t size() const
+  {
+    return left.size();
+  }
+};
+
+#define EXPR_VECTOR_OPERATOR(symbol, op)                                                           \
+  template <typename L, typename R>                                                                \
+  binary_expr<expr_detail::op, L, R> operator symbol(const vec_expr<L>& l, const vec_expr<R>& r) \
+  {                                                                                                \
+    return {l.self(), r.self()};                                                                   \
+  }                                                                                                \
+  template <typename L, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>>        \
+  binary_expr<expr_detail::op, L, scalar_expr<S>> operator symbol(const vec_expr<L>& l, S s)     \
+  {                                                                                                \
+    return {l.self(), scalar_expr<S>(s, l.self().size())};                                         \
+  }                                                                                                \
+  template <typename S, typename R, typename = std::enable_if_t<std::is_arithmetic_v<S>>>        \
+  binary_expr<expr_detail::op, scalar_expr<S>, R> operator symbol(S s, const vec_expr<R>& r)     \
+  {                                                                                                \
+    return {scalar_expr<S>(s, r.self().size()), r.self()};                                         \
+  }
+
+EXPR_VECTOR_OPERATOR(+, add)
+EXPR_VECTOR_OPERATOR(-, sub)
+EXPR_VECTOR_OPERATOR(*, mul)
+EXPR_VECTOR_OPERATOR(/, div)
+
+#undef EXPR_VECTOR_OPERATOR
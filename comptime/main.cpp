@@ -1,12 +1,208 @@
 #include "comp.hpp"
+#include "expr_vector.hpp"
+#include "static_map.hpp"
 #include <algorithm>
+#include <chrono>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <random>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+namespace
+{
+// C++ keywords to token ids: a typical static table of short strings.
+constexpr std::pair<std::string_view, int> kKeywords[] = {
+    {"alignas", 1}, {"alignof", 2}, {"and", 3}, {"asm", 4}, {"auto", 5}, {"bool", 6}, {"break", 7},
+    {"case", 8}, {"catch", 9}, {"char", 10}, {"class", 11}, {"const", 12}, {"consteval", 13},
+    {"constexpr", 14}, {"constinit", 15}, {"const_cast", 16}, {"continue", 17}, {"decltype", 18},
+    {"default", 19}, {"delete", 20}, {"do", 21}, {"double", 22}, {"dynamic_cast", 23}, {"else", 24},
+    {"enum", 25}, {"explicit", 26}, {"export", 27}, {"extern", 28}, {"false", 29}, {"float", 30},
+    {"for", 31}, {"friend", 32}, {"goto", 33}, {"if", 34}, {"inline", 35}, {"int", 36},
+    {"long", 37}, {"mutable", 38}, {"namespace", 39}, {"new", 40}, {"noexcept", 41}, {"not", 42},
+    {"nullptr", 43}, {"operator", 44}, {"or", 45}, {"private", 46}, {"protected", 47},
+    {"public", 48}, {"register", 49}, {"reinterpret_cast", 50}, {"requires", 51}, {"return", 52},
+    {"short", 53}, {"signed", 54}, {"sizeof", 55}, {"static", 56}, {"static_assert", 57},
+    {"static_cast", 58}, {"struct", 59}, {"switch", 60}, {"template", 61}, {"this", 62},
+    {"throw", 63}, {"true", 64}, {"try", 65}, {"typedef", 66}, {"typeid", 67}, {"typename", 68},
+    {"union", 69}, {"unsigned", 70}, {"using", 71}, {"virtual", 72}, {"void", 73}, {"volatile", 74},
+    {"while", 75}, {"xor", 76},
+};
+
+constexpr auto kFlatKeywords = make_flat_map(kKeywords);
+constexpr auto kHashedKeywords = make_perfect_hash_map(kKeywords);
+
+// Both tables are fully built by the compiler, so lookups on constant keys fold away.
+static_assert(kFlatKeywords.at("while") == 75 && kHashedKeywords.at("while") == 75);
+static_assert(!kFlatKeywords.contains("whilst") && !kHashedKeywords.contains("whilst"));
+static_assert(kHashedKeywords.size() == 76);
+
+template <typename Lookup>
+void bench_lookup(const char* name, const std::vector<std::string>& queries, Lookup&& lookup)
+{
+  constexpr int kRounds = 1000;
+  long sum = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int round = 0; round < kRounds; ++round)
+  {
+    for (const auto& query : queries)
+    {
+      sum += lookup(query);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+  std::cout << name << ": " << elapsed.count() / (kRounds * queries.size())
+            << " ns/lookup (checksum " << sum << ")" << std::endl;
+}
+
+// Operator overloading the obvious way: every operator returns a freshly allocated vector.
+struct naive_vector
+{
+  std::vector<float> data;
+};
+
+template <typename Op> naive_vector elementwise(const naive_vector& l, const naive_vector& r, Op op)
+{
+  naive_vector out{std::vector<float>(l.data.size())};
+  for (size_t i = 0; i < l.data.size(); ++i)
+  {
+    out.data[i] = op(l.data[i], r.data[i]);
+  }
+  return out;
+}
+
+naive_vector operator+(const naive_vector& l, const naive_vector& r)
+{
+  return elementwise(l, r, std::plus<>());
+}
+
+naive_vector operator-(const naive_vector& l, const naive_vector& r)
+{
+  return elementwise(l, r, std::minus<>());
+}
+
+naive_vector operator*(const naive_vector& l, const naive_vector& r)
+{
+  return elementwise(l, r, std::multiplies<>());
+}
+
+// Fills a, b, c, d the same way for every variant, evaluates a + b * c - d `reps` times and
+// returns the seconds per evaluation; `sum` gets a checksum of the result.
+template <typename Vec, typename Eval>
+double bench_fused(size_t n, size_t reps, double& sum, Eval&& eval)
+{
+  Vec a(n), b(n), c(n), d(n), out(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    a[i] = static_cast<float>(i % 7);
+    b[i] = static_cast<float>(i % 5) * 0.5f;
+    c[i] = static_cast<float>(i % 3) + 1.0f;
+    d[i] = static_cast<float>(i % 11) * 0.25f;
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t rep = 0; rep < reps; ++rep)
+  {
+    eval(out, a, b, c, d);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  sum = 0;
+  for (size_t i = 0; i < n; i += 1 + n / 1000)
+  {
+    sum += out[i];
+  }
+  return std::chrono::duration<double>(end - start).count() / reps;
+}
+
+// naive_vector with an element accessor, so bench_fused can fill it like the others.
+struct naive_operands : naive_vector
+{
+  explicit naive_operands(size_t n) : naive_vector{std::vector<float>(n)}
+  {
+  }
+  float& operator[](size_t i)
+  {
+    return data[i];
+  }
+};
+
+void bench_expressions()
+{
+  std::cout << "\na + b * c - d over float vectors, ns/element:" << std::endl
+            << "        n   hand loop   naive ops  expr templ" << std::endl;
+  for (size_t n = 1000; n <= 100000000; n *= 10)
+  {
+    size_t reps = std::max<size_t>(3, 300000000 / n);
+    double sums[3];
+    double hand = bench_fused<std::vector<float>>(
+        n, reps, sums[0], [](auto& out, auto& a, auto& b, auto& c, auto& d) {
+          for (size_t i = 0; i < out.size(); ++i)
+          {
+            out[i] = a[i] + b[i] * c[i] - d[i];
+          }
+        });
+    double naive = bench_fused<naive_operands>(
+        n, reps, sums[1], [](auto& out, auto& a, auto& b, auto& c, auto& d) {
+          static_cast<naive_vector&>(out) = a + b * c - d;
+        });
+    double fused = bench_fused<expr_vector<float>>(
+        n, reps, sums[2], [](auto& out, auto& a, auto& b, auto& c, auto& d) {
+          out = a + b * c - d;
+        });
+    if (sums[0] != sums[1] || sums[0] != sums[2])
+    {
+      throw std::logic_error("expression results differ");
+    }
+    std::cout << std::setw(9) << n << std::fixed << std::setprecision(3) << std::setw(12)
+              << hand / n * 1e9 << std::setw(12) << naive / n * 1e9 << std::setw(12)
+              << fused / n * 1e9 << std::defaultfloat << std::setprecision(6) << std::endl;
+  }
+}
+} // namespace
+
 int main()
 {
   std::cout << factorial<20>::value << '\n';
-}
\ No newline at end of file
+  bench_expressions();
+
+  // One query in ten misses. Few enough queries to stay in cache, so the tables are measured
+  // rather than the walk over the query strings.
+  std::vector<std::string> queries;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<size_t> pick(0, std::size(kKeywords) - 1);
+  for (int i = 0; i < 10000; ++i)
+  {
+    std::string key(kKeywords[pick(gen)].first);
+    queries.push_back(i % 10 == 0 ? key + "_" : key);
+  }
+
+  std::map<std::string, int, std::less<>> ordered;
+  std::unordered_map<std::string, int> hashed;
+  for (const auto& [key, value] : kKeywords)
+  {
+    ordered.emplace(key, value);
+    hashed.emplace(key, value);
+  }
+
+  std::cout << std::size(kKeywords) << " keywords, " << queries.size()
+            << " queries, 10% misses:" << std::endl;
+  bench_lookup("std::map", queries, [&](const std::string& key) {
+    auto it = ordered.find(key);
+    return it == ordered.end() ? 0 : it->second;
+  });
+  bench_lookup("std::unordered_map", queries, [&](const std::string& key) {
+    auto it = hashed.find(key);
+    return it == hashed.end() ? 0 : it->second;
+  });
+  bench_lookup("static_flat_map", queries, [](const std::string& key) {
+    const int* value = kFlatKeywords.find(key);
+    return value ? *value : 0;
+  });
+  bench_lookup("perfect_hash_map", queries, [](const std::string& key) {
+    const int* value = kHashedKeywords.find(key);
+    return value ? *value : 0;
+  });
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// Read-only string-keyed tables built entirely at compile time from a constexpr array of
+// {key, value} pairs, for the static tables (command names, opcodes, enum spellings) that would
+// otherwise be std::maps filled at startup:
+//
+//   constexpr std::pair<std::string_view, int> kOps[] = {{"add", 1}, {"sub", 2}};
+//   constexpr auto ops = make_perfect_hash_map(kOps);
+//   static_assert(ops.at("sub") == 2);
+//
+// A duplicate key is a compile error in both builders. Values must be literal types with a
+// default constructor.
+
+namespace static_map_detail
+{
+// FNV-1a: keys are short, and it is trivially constexpr.
+constexpr uint64_t hash(std::string_view key)
+{
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (char c : key)
+  {
+    h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+  }
+  return h;
+}
+
+// Rehashes a key's hash under a seed, then scales it onto [0, n) without a division.
+constexpr uint32_t slot(uint64_t h, uint32_t seed, size_t n)
+{
+  uint64_t x = h ^ (seed * 0x9e3779b97f4a7c15ull);
+  x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return static_cast<uint32_t>(((x >> 32) * n) >> 32);
+}
+} // namespace static_map_detail
+
+// Entries sorted by key length, then by bytes; lookup is a binary search of about log2(N)
+// compares, most of them settled by the length alone.
+template <typename V, size_t N> class static_flat_map
+{
+private:
+  std::array<std::string_view, N> keys{};
+  std::array<V, N> values{};
+
+  static constexpr bool less(std::string_view a, std::string_view b)
+  {
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+  }
+
+public:
+  constexpr explicit static_flat_map(const std::pair<std::string_view, V> (&entries)[N])
+  {
+    // Insertion sort: std::sort is not constexpr until C++20.
+    for (size_t i = 0; i < N; ++i)
+    {
+      size_t j = i;
+      for (; j > 0 && less(entries[i].first, keys[j - 1]); --j)
+      {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+      }
+      keys[j] = entries[i].first;
+      values[j] = entries[i].second;
+    }
+    for (size_t i = 1; i < N; ++i)
+    {
+      if (keys[i] == keys[i - 1])
+      {
+        throw std::logic_error("duplicate key in static_flat_map");
+      }
+    }
+  }
+
+  constexpr const V* find(std::string_view key) const
+  {
+    size_t low = 0;
+    size_t high = N;
+    while (low < high)
+    {
+      size_t mid = low + (high - low) / 2;
+      if (less(keys[mid], key))
+      {
+        low = mid + 1;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+    return low < N && keys[low] == key ? &values[low] : nullptr;
+  }
+
+  constexpr const V& at(std::string_view key) const
+  {
+    const V* value = find(key);
+    if (!value)
+    {
+      throw std::out_of_range("key not in static_flat_map");
+    }
+    return *value;
+  }
+
+  constexpr bool contains(std::string_view key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  constexpr size_t size() const
+  {
+    return N;
+  }
+};
+
+// Minimal perfect hash by hash-and-displace: keys are split into N buckets by one hash, and each
+// bucket, largest first, gets the first seed that sends all of its keys to free slots of an
+// N-slot table. A lookup hashes the key once, rehashes it with its bucket's seed and does a
+// single string compare, which also rejects keys that were never in the table.
+template <typename V, size_t N> class perfect_hash_map
+{
+private:
+  static constexpr uint32_t kMaxSeed = 1u << 20;
+
+  std::array<uint32_t, N> seeds{};
+  std::array<std::string_view, N> keys{};
+  std::array<V, N> values{};
+
+public:
+  constexpr explicit perfect_hash_map(const std::pair<std::string_view, V> (&entries)[N])
+  {
+    using static_map_detail::hash;
+    using static_map_detail::slot;
+
+    // Group entry indices by bucket: a counting sort.
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, N + 1> start{};
+    for (size_t i = 0; i < N; ++i)
+    {
+      hashes[i] = hash(entries[i].first);
+      ++start[slot(hashes[i], 0, N) + 1];
+    }
+    for (size_t b = 0; b < N; ++b)
+    {
+      start[b + 1] += start[b];
+    }
+    std::array<size_t, N> members{};
+    std::array<size_t, N> fill{};
+    for (size_t i = 0; i < N; ++i)
+    {
+      size_t b = slot(hashes[i], 0, N);
+      members[start[b] + fill[b]++] = i;
+    }
+
+    // Buckets by descending size, so the crowded ones are placed while the table is empty.
+    std::array<size_t, N> order{};
+    for (size_t b = 0; b < N; ++b)
+    {
+      size_t j = b;
+      for (; j > 0 && fill[order[j - 1]] < fill[b]; --j)
+      {
+        order[j] = order[j - 1];
+      }
+      order[j] = b;
+    }
+
+    std::array<bool, N> taken{};
+    for (size_t b : order)
+    {
+      size_t count = fill[b];
+      if (count == 0)
+      {
+        break;
+      }
+      for (size_t m = 1; m < count; ++m)
+      {
+        for (size_t other = 0; other < m; ++other)
+        {
+          if (entries[members[start[b] + m]].first == entries[members[start[b] + other]].first)
+          {
+            throw std::logic_error("duplicate key in perfect_hash_map");
+          }
+        }
+      }
+      uint32_t seed = 1;
+      for (;; ++seed)
+      {
+        if (seed == kMaxSeed)
+        {
+          throw std::logic_error("no perfect hash seed found");
+        }
+        bool fits = true;
+        for (size_t m = 0; m < count && fits; ++m)
+        {
+          uint32_t s = slot(hashes[members[start[b] + m]], seed, N);
+          fits = !taken[s];
+          for (size_t other = 0; other < m && fits; ++other)
+          {
+            fits = slot(hashes[members[start[b] + other]], seed, N) != s;
+          }
+        }
+        if (fits)
+        {
+          break;
+        }
+      }
+      seeds[b] = seed;
+      for (size_t m = 0; m < count; ++m)
+      {
+        size_t i = members[start[b] + m];
+        uint32_t s = slot(hashes[i], seed, N);
+        taken[s] = true;
+        keys[s] = entries[i].first;
+        values[s] = entries[i].second;
+      }
+    }
+  }
+
+  constexpr const V* find(std::string_view key) const
+  {
+    uint64_t h = static_map_detail::hash(key);
+    uint32_t s = static_map_detail::slot(h, seeds[static_map_detail::slot(h, 0, N)], N);
+    return keys[s] == key ? &values[s] : nullptr;
+  }
+
+  constexpr const V& at(std::string_view key) const
+  {
+    const V* value = find(key);
+    if (!value)
+    {
+      throw std::out_of_range("key not in perfect_hash_map");
+    }
+    return *value;
+  }
+
+  constexpr bool contains(std::string_view key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  constexpr size_t size() const
+  {
+    return N;
+  }
+};
+
+template <typename V, size_t N>
+constexpr static_flat_map<V, N> make_flat_map(const std::pair<std::string_view, V> (&entries)[N])
+{
+  return static_flat_map<V, N>(entries);
+}
+
+template <typename V, size_t N>
+constexpr perfect_hash_map<V, N>
+make_perfect_hash_map(const std::pair<std::string_view, V> (&entries)[N])
+{
+  return perfect_hash_map<V, N>(entries);
+}
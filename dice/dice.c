@@ -1,13 +1,14 @@
 #include "dice_backgammon.h"
 #include "dice_constants.h"
+#include "dice_file.h"
 #include "dice_generic.h"
 #include "dice_regular.h"
+#include "dice_stats.h"
 #include <linux/cdev.h>
 #include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
-#include <linux/mutex.h>
 #include <linux/random.h>
 
 #define NUM_DEVICES 3
@@ -28,17 +29,23 @@ static int __init dice_init(void)
   int ret;
   dev_t device_number;
 
-  if (common_sides < 1 || common_sides > 100)
+  if (common_sides < 1 || common_sides > MAX_SIDE_COUNT)
   {
     pr_err("Invalid sides value: %d (must be 1-100)\n", common_sides);
     return -EINVAL;
   }
 
+  ret = dice_file_init();
+  if (ret)
+  {
+    return ret;
+  }
+
   ret = alloc_chrdev_region(&device_number, 0, NUM_DEVICES, "dice");
   if (ret < 0)
   {
     printk(KERN_ERR "dice: failed to allocate major numbers\n");
-    return ret;
+    goto exit_file;
   }
 
   device_major = MAJOR(device_number);
@@ -51,27 +58,26 @@ static int __init dice_init(void)
     goto unregister_chrdev;
   }
 
-  // Regular dice device (dice0)
-  regular_dev = kmalloc(sizeof(struct regular_dice_device), GFP_KERNEL);
-  if (!regular_dev)
+  ret = dice_stats_register(dice_class);
+  if (ret)
   {
-    ret = -ENOMEM;
     goto destroy_class;
   }
-  regular_dev->dice_values = kmalloc_array(MAX_DICE_COUNT, sizeof(int), GFP_KERNEL);
-  if (!regular_dev->dice_values)
+
+  // Regular dice device (dice0)
+  regular_dev = kmalloc(sizeof(struct regular_dice_device), GFP_KERNEL);
+  if (!regular_dev)
   {
     ret = -ENOMEM;
-    goto free_regular_dev;
+    goto unregister_stats;
   }
   regular_dev->dice_count = 1;
-  mutex_init(&regular_dev->mutex);
   cdev_init(&regular_dev->cdev, &regular_dice_fops);
   regular_dev->cdev.owner = THIS_MODULE;
   ret = cdev_add(&regular_dev->cdev, MKDEV(device_major, 0), 1);
   if (ret)
   {
-    goto free_regular_values;
+    goto free_regular_dev;
   }
   if (IS_ERR(device_create(dice_class, NULL, MKDEV(device_major, 0), NULL, "dice%d", 0)))
   {
@@ -86,20 +92,13 @@ static int __init dice_init(void)
     ret = -ENOMEM;
     goto destroy_regular_device;
   }
-  backgammon_dev->dice_values = kmalloc_array(BACKGAMMON_DICE_COUNT * MAX_DICE_COUNT, sizeof(int), GFP_KERNEL);
-  if (!backgammon_dev->dice_values)
-  {
-    ret = -ENOMEM;
-    goto free_backgammon_dev;
-  }
   backgammon_dev->dice_count = 2;
-  mutex_init(&backgammon_dev->mutex);
   cdev_init(&backgammon_dev->cdev, &backgammon_dice_fops);
   backgammon_dev->cdev.owner = THIS_MODULE;
   ret = cdev_add(&backgammon_dev->cdev, MKDEV(device_major, 1), 1);
   if (ret)
   {
-    goto free_backgammon_values;
+    goto free_backgammon_dev;
   }
   if (IS_ERR(device_create(dice_class, NULL, MKDEV(device_major, 1), NULL, "dice%d", 1)))
   {
@@ -114,21 +113,14 @@ static int __init dice_init(void)
     ret = -ENOMEM;
     goto destroy_backgammon_device;
   }
-  generic_dev->dice_values = kmalloc_array(MAX_DICE_COUNT, sizeof(int), GFP_KERNEL);
-  if (!generic_dev->dice_values)
-  {
-    ret = -ENOMEM;
-    goto free_generic_dev;
-  }
   generic_dev->dice_count = 1;
   generic_dev->side_count = common_sides;
-  mutex_init(&generic_dev->mutex);
   cdev_init(&generic_dev->cdev, &generic_dice_fops);
   generic_dev->cdev.owner = THIS_MODULE;
   ret = cdev_add(&generic_dev->cdev, MKDEV(device_major, 2), 1);
   if (ret)
   {
-    goto free_generic_values;
+    goto free_generic_dev;
   }
   if (IS_ERR(device_create(dice_class, NULL, MKDEV(device_major, 2), NULL, "dice%d", 2)))
   {
@@ -141,30 +133,28 @@ static int __init dice_init(void)
 
 destroy_generic_cdev:
   cdev_del(&generic_dev->cdev);
-free_generic_values:
-  kfree(generic_dev->dice_values);
 free_generic_dev:
   kfree(generic_dev);
 destroy_backgammon_device:
   device_destroy(dice_class, MKDEV(device_major, 1));
 destroy_backgammon_cdev:
   cdev_del(&backgammon_dev->cdev);
-free_backgammon_values:
-  kfree(backgammon_dev->dice_values);
 free_backgammon_dev:
   kfree(backgammon_dev);
 destroy_regular_device:
   device_destroy(dice_class, MKDEV(device_major, 0));
 destroy_regular_cdev:
   cdev_del(&regular_dev->cdev);
-free_regular_values:
-  kfree(regular_dev->dice_values);
 free_regular_dev:
   kfree(regular_dev);
+unregister_stats:
+  dice_stats_unregister(dice_class);
 destroy_class:
   class_destroy(dice_class);
 unregister_chrdev:
   unregister_chrdev_region(device_number, NUM_DEVICES);
+exit_file:
+  dice_file_exit();
   return ret;
 }
 
@@ -172,21 +162,20 @@ static void __exit dice_exit(void)
 {
   device_destroy(dice_class, MKDEV(device_major, 2));
   cdev_del(&generic_dev->cdev);
-  kfree(generic_dev->dice_values);
   kfree(generic_dev);
 
   device_destroy(dice_class, MKDEV(device_major, 1));
   cdev_del(&backgammon_dev->cdev);
-  kfree(backgammon_dev->dice_values);
   kfree(backgammon_dev);
 
   device_destroy(dice_class, MKDEV(device_major, 0));
   cdev_del(&regular_dev->cdev);
-  kfree(regular_dev->dice_values);
   kfree(regular_dev);
 
+  dice_stats_unregister(dice_class);
   class_destroy(dice_class);
   unregister_chrdev_region(MKDEV(device_major, 0), NUM_DEVICES);
+  dice_file_exit();
   printk(KERN_INFO "dice: module unloaded\n");
 }
 module_init(dice_init);
@@ -1,133 +1,113 @@
 #include "dice_backgammon.h"
+#include "dice_bulk.h"
 #include "dice_constants.h"
+#include "dice_file.h"
+#include "dice_ring.h"
 #include <linux/kernel.h>
+#include <linux/uaccess.h>
 
-static void roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values);
+static int roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values);
 
 int backgammon_dice_open(struct inode* inode, struct file* file)
 {
   struct backgammon_dice_device* dev;
-  dev = container_of(inode->i_cdev, struct backgammon_dice_device, cdev);
-  file->private_data = dev;
 
-  printk(KERN_INFO "Backgammon dice device opened\n");
-  return 0;
+  dev = container_of(inode->i_cdev, struct backgammon_dice_device, cdev);
+  return dice_file_open(file, dev, dev->dice_count, BACKGAMMON_DICE_SIDECOUNT);
 }
 
 int backgammon_dice_release(struct inode* inode, struct file* file)
 {
-  printk(KERN_INFO "Backgammon dice device closed\n");
+  dice_file_release(file);
   return 0;
 }
 
-// set dice when read, print to the buffer
-long backgammon_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset)
+static int render_dice(char* text, int* values, int* rolled, const struct dice_file* state)
 {
-  struct backgammon_dice_device* dev = file->private_data;
-  char* output_buffer;
   int total_len = 0;
-  int ret;
-
-  // has read some data
-  if (*offset > 0)
-  {
-    return 0;
-  }
-
-  mutex_lock(&dev->mutex);
-
-  output_buffer = kmalloc(PAGE_SIZE, GFP_KERNEL);
-  if (!output_buffer)
-  {
-    mutex_unlock(&dev->mutex);
-    return -ENOMEM;
-  }
 
-  roll_dice(output_buffer, &total_len, dev->dice_count, dev->dice_values);
-
-  if (count < total_len)
-  {
-    kfree(output_buffer);
-    mutex_unlock(&dev->mutex);
-    return -EINVAL;
-  }
-  ret = copy_to_user(buffer, output_buffer, total_len);
-  kfree(output_buffer);
-  mutex_unlock(&dev->mutex);
-  if (ret)
-  {
-    return -EFAULT;
-  }
-
-  *offset = total_len;
+  *rolled = roll_dice(text, &total_len, READ_ONCE(state->dice_count), values);
   return total_len;
 }
 
+// set dice when read, print to the buffer
+long backgammon_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset)
+{
+  return dice_file_read(file, buffer, count, offset, render_dice);
+}
+
 // set dice count when writing into the file
-long backgammon_dice_write(struct file* file,
-                           const char __user* buffer,
-                           size_t count,
-                           loff_t* offset)
+static long
+set_dice_count(struct dice_file* state, const char __user* buffer, size_t count, loff_t* offset)
 {
-  struct backgammon_dice_device* dev = file->private_data;
-  char* input_buffer;
-  int ret;
+  char input_buffer[DICE_WRITE_MAX + 1];
+  int dice_count;
 
   if (*offset > 0)
   {
     return 0;
   }
 
-  if (count > 32)
+  if (count > DICE_WRITE_MAX)
   {
     return -EINVAL;
   }
 
-  mutex_lock(&dev->mutex);
-
-  input_buffer = kmalloc(count + 1, GFP_KERNEL);
-  if (!input_buffer)
-  {
-    mutex_unlock(&dev->mutex);
-    return -ENOMEM;
-  }
-
-  ret = copy_from_user(input_buffer, buffer, count);
-  if (ret)
+  if (copy_from_user(input_buffer, buffer, count))
   {
-    kfree(input_buffer);
-    mutex_unlock(&dev->mutex);
     return -EFAULT;
   }
 
   input_buffer[count] = '\0'; // Null-terminate the string
 
-  ret = kstrtoint(input_buffer, 10, &dev->dice_count);
-  if (ret)
+  if (kstrtoint(input_buffer, 10, &dice_count))
   {
-    kfree(input_buffer);
-    mutex_unlock(&dev->mutex);
     return -EINVAL;
   }
-
-  kfree(input_buffer);
-  mutex_unlock(&dev->mutex);
+  WRITE_ONCE(state->dice_count, dice_count);
 
   return count;
 }
 
-static void roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values)
+long backgammon_dice_write(struct file* file,
+                           const char __user* buffer,
+                           size_t count,
+                           loff_t* offset)
 {
+  return dice_file_write_done(file, set_dice_count(file->private_data, buffer, count, offset));
+}
+
+// binary bulk mode: packed rolls straight into the user buffer, no text and no allocation
+long backgammon_dice_ioctl(struct file* file, unsigned int cmd, unsigned long arg)
+{
+  return dice_bulk_ioctl(cmd, arg, BACKGAMMON_DICE_SIDECOUNT);
+}
+
+// zero-copy mode: map a per-open ring the kernel keeps topped up with rolls
+int backgammon_dice_mmap(struct file* file, struct vm_area_struct* vma)
+{
+  return dice_ring_mmap(file->private_data, vma, BACKGAMMON_DICE_SIDECOUNT);
+}
+
+__poll_t backgammon_dice_poll(struct file* file, poll_table* wait)
+{
+  return dice_ring_poll(file, wait);
+}
+
+static int roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values)
+{
+  u8 rolls[BACKGAMMON_DICE_COUNT * MAX_DICE_COUNT];
+
   if (dice_count < 1 || dice_count > MAX_DICE_COUNT)
   {
     *total_len +=
         sprintf(output_buffer + *total_len, "The input is %d, invalid dice count\n", dice_count);
-    return;
+    return 0;
   }
-  for (int i = 0; i < dice_count; i++)
+  dice_bulk_fill(rolls, dice_count * BACKGAMMON_DICE_COUNT, BACKGAMMON_DICE_SIDECOUNT);
+  for (int i = 0; i < dice_count * BACKGAMMON_DICE_COUNT; i++)
   {
-    dice_values[i * 2] = get_random_u32() % BACKGAMMON_DICE_SIDECOUNT + 1;
-    dice_values[i * 2 + 1] = get_random_u32() % BACKGAMMON_DICE_SIDECOUNT + 1;
+    dice_values[i] = rolls[i];
   }
 
   for (int i = 0; i < dice_count; i++)
@@ -137,4 +117,5 @@ static void roll_dice(char* output_buffer, int* total_len, int dice_count, int*
                               ? dice_values[i * 2] * 2
                               : dice_values[i * 2] + dice_values[i * 2 + 1]);
   }
+  return dice_count * BACKGAMMON_DICE_COUNT;
 }
\ No newline at end of file
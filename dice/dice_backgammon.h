@@ -2,7 +2,7 @@
 #define DICE_BACKGAMMON_H
 
 #include <linux/cdev.h>
-#include <linux/mutex.h>
+#include <linux/poll.h>
 
 #define BACKGAMMON_DICE_SIDECOUNT 6
 #define BACKGAMMON_DICE_COUNT 2
@@ -10,9 +10,7 @@
 struct backgammon_dice_device
 {
   struct cdev cdev;
-  struct mutex mutex;
   int dice_count;
-  int* dice_values;
 };
 
 int backgammon_dice_open(struct inode* inode, struct file* file);
@@ -22,6 +20,9 @@ long backgammon_dice_write(struct file* file,
                            const char __user* buffer,
                            size_t count,
                            loff_t* offset);
+long backgammon_dice_ioctl(struct file* file, unsigned int cmd, unsigned long arg);
+int backgammon_dice_mmap(struct file* file, struct vm_area_struct* vma);
+__poll_t backgammon_dice_poll(struct file* file, poll_table* wait);
 
 static struct file_operations backgammon_dice_fops = {
     .owner = THIS_MODULE,
@@ -29,6 +30,10 @@ static struct file_operations backgammon_dice_fops = {
     .release = backgammon_dice_release,
     .read = backgammon_dice_read,
     .write = backgammon_dice_write,
+    .unlocked_ioctl = backgammon_dice_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .mmap = backgammon_dice_mmap,
+    .poll = backgammon_dice_poll,
 };
 
 #endif // DICE_BACKGAMMON_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "dice_ioctl.h"
+#include "dice_ring_reader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+constexpr size_t kRolls = 10000000;
+constexpr size_t kBatch = 4096;
+constexpr int kTextDice = 20; // MAX_DICE_COUNT in the module
+
+// Text path: one pread per kTextDice dice, ASCII art included.
+double bench_text(const char* path, size_t rolls)
+{
+  int fd = ::open(path, O_RDWR);
+  if (fd < 0)
+  {
+    std::perror(path);
+    return 0;
+  }
+  std::string count = std::to_string(kTextDice);
+  if (::write(fd, count.c_str(), count.size()) < 0)
+  {
+    std::perror("write");
+  }
+
+  char buffer[4096];
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t done = 0; done < rolls; done += kTextDice)
+  {
+    if (::pread(fd, buffer, sizeof(buffer), 0) <= 0)
+    {
+      std::perror("pread");
+      break;
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  ::close(fd);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double bench_ioctl(const char* path, size_t rolls)
+{
+  int fd = ::open(path, O_RDWR);
+  if (fd < 0)
+  {
+    std::perror(path);
+    return 0;
+  }
+
+  std::vector<uint8_t> buffer(kBatch);
+  dice_bulk_request req{};
+  req.buffer = reinterpret_cast<uintptr_t>(buffer.data());
+  req.count = kBatch;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t done = 0; done < rolls; done += kBatch)
+  {
+    if (::ioctl(fd, DICE_IOC_BULK_ROLL, &req) < 0)
+    {
+      std::perror("ioctl");
+      break;
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  ::close(fd);
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double bench_ring(const char* path, size_t rolls)
+{
+  DiceRingReader reader(path);
+  std::vector<uint8_t> buffer(kBatch);
+  uint64_t sum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t done = 0; done < rolls; done += kBatch)
+  {
+    reader.read(buffer.data(), kBatch);
+    sum += buffer[0];
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  if (sum == 0)
+  {
+    std::cerr << "ring returned no rolls\n";
+  }
+  return std::chrono::duration<double>(end - start).count();
+}
+
+void report(const char* name, double seconds, size_t rolls)
+{
+  std::cout << name << ": " << seconds << " s, " << (seconds > 0 ? rolls / seconds / 1e6 : 0)
+            << " M rolls/s" << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "/dev/dice0";
+  size_t rolls = argc > 2 ? std::stoul(argv[2]) : kRolls;
+
+  report("read (text)", bench_text(path, rolls / 100), rolls / 100);
+  report("ioctl (bulk)", bench_ioctl(path, rolls), rolls);
+  try
+  {
+    report("mmap (ring)", bench_ring(path, rolls), rolls);
+  }
+  catch (const std::system_error& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "dice_bulk.h"
+#include "dice_ioctl.h"
+#include "dice_roll.h"
+#include "dice_stats.h"
+#include "dice_trace.h"
+#include <linux/kernel.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/sched/signal.h>
+#include <linux/string.h>
+#include <linux/uaccess.h>
+
+// Rolls are generated a chunk at a time on the stack, each random word yielding several dice (see
+// dice_roll.h), and the chunk is copied straight to userspace.
+#define DICE_BULK_CHUNK 256
+
+void dice_bulk_fill(u8* dst, size_t count, unsigned int sides)
+{
+  struct dice_roller roller;
+  u8 last[DICE_ROLL_MAX_PER_WORD];
+  size_t produced = 0;
+
+  trace_dice_roll(count, sides);
+  dice_roller_init(&roller, sides);
+  while (count - produced >= roller.per_word)
+  {
+    if (dice_roller_extract(&roller, get_random_u32(), dst + produced))
+    {
+      produced += roller.per_word;
+    }
+  }
+
+  // Fewer than a word's worth left: extract into a spare buffer and keep what we need.
+  while (produced < count)
+  {
+    if (dice_roller_extract(&roller, get_random_u32(), last))
+    {
+      memcpy(dst + produced, last, count - produced);
+      produced = count;
+    }
+  }
+}
+
+static long dice_bulk_roll(u8 __user* dst, u64 count, unsigned int sides)
+{
+  u8 chunk[DICE_BULK_CHUNK];
+  u64 done = 0;
+
+  while (done < count)
+  {
+    size_t want = min_t(u64, count - done, DICE_BULK_CHUNK);
+
+    dice_bulk_fill(chunk, want, sides);
+    if (copy_to_user(dst + done, chunk, want))
+    {
+      return -EFAULT;
+    }
+    dice_stat_add(rolls, want);
+    done += want;
+
+    if (fatal_signal_pending(current))
+    {
+      return done ? done : -EINTR;
+    }
+    cond_resched();
+  }
+
+  return done;
+}
+
+static long dice_bulk_request_rolls(unsigned int cmd, unsigned long arg, int default_sides)
+{
+  struct dice_bulk_request req;
+  unsigned int sides;
+
+  if (cmd != DICE_IOC_BULK_ROLL)
+  {
+    return -ENOTTY;
+  }
+
+  if (copy_from_user(&req, (void __user*)arg, sizeof(req)))
+  {
+    return -EFAULT;
+  }
+
+  sides = req.sides ? req.sides : default_sides;
+  if (sides < 1 || sides > DICE_BULK_MAX_SIDES || req.reserved)
+  {
+    return -EINVAL;
+  }
+
+  // The return value is a long, so cap what a single call may deliver.
+  req.count = min_t(u64, req.count, MAX_RW_COUNT);
+  if (!access_ok(u64_to_user_ptr(req.buffer), req.count))
+  {
+    return -EFAULT;
+  }
+
+  return dice_bulk_roll(u64_to_user_ptr(req.buffer), req.count, sides);
+}
+
+long dice_bulk_ioctl(unsigned int cmd, unsigned long arg, int default_sides)
+{
+  long ret = dice_bulk_request_rolls(cmd, arg, default_sides);
+
+  dice_stat_inc(ioctls);
+  if (ret < 0)
+  {
+    dice_stat_inc(errors);
+  }
+  else
+  {
+    dice_stat_add(bytes, ret);
+  }
+  return ret;
+}
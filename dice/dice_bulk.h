@@ -0,0 +1,10 @@
+#ifndef DICE_BULK_H
+#define DICE_BULK_H
+
+#include <linux/fs.h>
+#include <linux/types.h>
+
+void dice_bulk_fill(u8* dst, size_t count, unsigned int sides);
+long dice_bulk_ioctl(unsigned int cmd, unsigned long arg, int default_sides);
+
+#endif // DICE_BULK_H
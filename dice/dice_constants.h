@@ -4,5 +4,9 @@
 #define DEVICE_NAME "dice%d"
 #define CLASS_NAME "dice_class"
 #define MAX_DICE_COUNT 20
+#define MAX_SIDE_COUNT 100
+#define MAX_DICE_VALUES (2 * MAX_DICE_COUNT) // backgammon rolls a pair per count
+#define DICE_TEXT_MAX 2048                   // longest text read: 20 regular dice with art
+#define DICE_WRITE_MAX 32
 
 #endif // DICE_CONSTANTS_H
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "dice_file.h"
+#include "dice_constants.h"
+#include "dice_ring.h"
+#include "dice_stats.h"
+#include "dice_trace.h"
+#include <linux/percpu.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+
+// Scratch space for rendering one read; replaces the kmalloc(PAGE_SIZE) every read used to do.
+struct dice_scratch
+{
+  char text[DICE_TEXT_MAX];
+  int values[MAX_DICE_VALUES];
+};
+
+static struct dice_scratch __percpu* dice_scratch;
+
+int dice_file_init(void)
+{
+  dice_scratch = alloc_percpu(struct dice_scratch);
+  return dice_scratch ? 0 : -ENOMEM;
+}
+
+void dice_file_exit(void)
+{
+  free_percpu(dice_scratch);
+}
+
+int dice_file_open(struct file* file, void* dev, int dice_count, int side_count)
+{
+  struct dice_file* state;
+
+  state = kzalloc(sizeof(*state), GFP_KERNEL);
+  if (!state)
+  {
+    return -ENOMEM;
+  }
+  state->dev = dev;
+  state->dice_count = dice_count;
+  state->side_count = side_count;
+  file->private_data = state;
+  dice_stat_inc(opens);
+  return 0;
+}
+
+void dice_file_release(struct file* file)
+{
+  struct dice_file* state = file->private_data;
+
+  if (state->ring)
+  {
+    dice_ring_destroy(state->ring);
+  }
+  kfree(state);
+  file->private_data = NULL;
+}
+
+// Render into this CPU's scratch buffer with preemption off and copy out with page faults
+// disabled. If the user buffer is not resident, fault it in outside the critical section and
+// roll again.
+static long dice_file_copy_out(struct dice_file* state,
+                               char __user* buffer,
+                               size_t count,
+                               loff_t* offset,
+                               dice_render_fn render)
+{
+  struct dice_scratch* scratch;
+  unsigned long uncopied;
+  int total_len;
+  int rolled;
+
+  // has read some data
+  if (*offset > 0)
+  {
+    return 0;
+  }
+
+  do
+  {
+    scratch = get_cpu_ptr(dice_scratch);
+    total_len = render(scratch->text, scratch->values, &rolled, state);
+    if (count < total_len)
+    {
+      put_cpu_ptr(dice_scratch);
+      return -EINVAL;
+    }
+    if (!access_ok(buffer, total_len))
+    {
+      put_cpu_ptr(dice_scratch);
+      return -EFAULT;
+    }
+    pagefault_disable();
+    uncopied = __copy_to_user_inatomic(buffer, scratch->text, total_len);
+    pagefault_enable();
+    put_cpu_ptr(dice_scratch);
+
+    if (uncopied && fault_in_writeable(buffer, total_len))
+    {
+      return -EFAULT;
+    }
+  } while (uncopied);
+
+  // Only the roll that reached the user counts; the ones lost to a fault retry do not.
+  dice_stat_add(rolls, rolled);
+  *offset = total_len;
+  return total_len;
+}
+
+long dice_file_read(struct file* file,
+                    char __user* buffer,
+                    size_t count,
+                    loff_t* offset,
+                    dice_render_fn render)
+{
+  struct dice_file* state = file->private_data;
+  long ret = dice_file_copy_out(state, buffer, count, offset, render);
+
+  trace_dice_read(iminor(file_inode(file)), READ_ONCE(state->dice_count),
+                  READ_ONCE(state->side_count), ret);
+  dice_stat_inc(reads);
+  if (ret < 0)
+  {
+    dice_stat_inc(errors);
+  }
+  else
+  {
+    dice_stat_add(bytes, ret);
+  }
+  return ret;
+}
+
+long dice_file_write_done(struct file* file, long ret)
+{
+  struct dice_file* state = file->private_data;
+
+  trace_dice_write(iminor(file_inode(file)), READ_ONCE(state->dice_count),
+                   READ_ONCE(state->side_count), ret);
+  dice_stat_inc(writes);
+  if (ret < 0)
+  {
+    dice_stat_inc(errors);
+  }
+  return ret;
+}
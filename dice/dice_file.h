@@ -0,0 +1,35 @@
+#ifndef DICE_FILE_H
+#define DICE_FILE_H
+
+#include <linux/fs.h>
+
+struct dice_ring;
+
+// Per-open state hung off file->private_data. Each opener has its own dice and side count, so a
+// write from one process no longer changes what other readers get, and reads need no lock.
+struct dice_file
+{
+  void* dev;
+  int dice_count;
+  int side_count;
+  struct dice_ring* ring; // created on first mmap
+};
+
+// Rolls state->dice_count dice into values and renders them into text, returning the length and
+// storing the number of dice rolled in *rolled.
+typedef int (*dice_render_fn)(char* text, int* values, int* rolled, const struct dice_file* state);
+
+int dice_file_init(void);
+void dice_file_exit(void);
+
+int dice_file_open(struct file* file, void* dev, int dice_count, int side_count);
+void dice_file_release(struct file* file);
+long dice_file_read(struct file* file,
+                    char __user* buffer,
+                    size_t count,
+                    loff_t* offset,
+                    dice_render_fn render);
+// Counts and traces a write the device has parsed; returns ret unchanged.
+long dice_file_write_done(struct file* file, long ret);
+
+#endif // DICE_FILE_H
@@ -1,130 +1,128 @@
 #include "dice_generic.h"
+#include "dice_bulk.h"
 #include "dice_constants.h"
+#include "dice_file.h"
+#include "dice_ring.h"
 #include <linux/kernel.h>
+#include <linux/uaccess.h>
 
-static void
+static int
 roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values, int side_count);
 
 int generic_dice_open(struct inode* inode, struct file* file)
 {
   struct generic_dice_device* dev;
-  dev = container_of(inode->i_cdev, struct generic_dice_device, cdev);
-  file->private_data = dev;
 
-  printk(KERN_INFO "Generic dice device opened\n");
-  return 0;
+  dev = container_of(inode->i_cdev, struct generic_dice_device, cdev);
+  return dice_file_open(file, dev, dev->dice_count, dev->side_count);
 }
 
 int generic_dice_release(struct inode* inode, struct file* file)
 {
-  printk(KERN_INFO "Generic dice device closed\n");
+  dice_file_release(file);
   return 0;
 }
 
-// set dice when read, print to the buffer
-long generic_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset)
+static int render_dice(char* text, int* values, int* rolled, const struct dice_file* state)
 {
-  struct generic_dice_device* dev = file->private_data;
-  char* output_buffer;
   int total_len = 0;
-  int ret;
-
-  // has read some data
-  if (*offset > 0)
-  {
-    return 0;
-  }
-
-  mutex_lock(&dev->mutex);
-
-  output_buffer = kmalloc(PAGE_SIZE, GFP_KERNEL);
-  if (!output_buffer)
-  {
-    mutex_unlock(&dev->mutex);
-    return -ENOMEM;
-  }
-
-  roll_dice(output_buffer, &total_len, dev->dice_count, dev->dice_values, dev->side_count);
 
-  if (count < total_len)
-  {
-    kfree(output_buffer);
-    mutex_unlock(&dev->mutex);
-    return -EINVAL;
-  }
-  ret = copy_to_user(buffer, output_buffer, total_len);
-  kfree(output_buffer);
-  mutex_unlock(&dev->mutex);
-  if (ret)
-  {
-    return -EFAULT;
-  }
-
-  *offset = total_len;
+  *rolled = roll_dice(text, &total_len, READ_ONCE(state->dice_count), values,
+                      READ_ONCE(state->side_count));
   return total_len;
 }
 
+// set dice when read, print to the buffer
+long generic_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset)
+{
+  return dice_file_read(file, buffer, count, offset, render_dice);
+}
+
 // set dice count and side count when writing into the file
-long generic_dice_write(struct file* file, const char __user* buffer, size_t count, loff_t* offset)
+static long
+set_dice_shape(struct dice_file* state, const char __user* buffer, size_t count, loff_t* offset)
 {
-  struct generic_dice_device* dev = file->private_data;
-  char* input_buffer;
-  int ret;
+  char input_buffer[DICE_WRITE_MAX + 1];
+  int dice_count;
+  int side_count;
+  int parsed;
 
   if (*offset > 0)
   {
     return 0;
   }
 
-  if (count > 32)
+  if (count > DICE_WRITE_MAX)
   {
     return -EINVAL;
   }
 
-  mutex_lock(&dev->mutex);
-
-  input_buffer = kmalloc(count + 1, GFP_KERNEL);
-  if (!input_buffer)
+  if (copy_from_user(input_buffer, buffer, count))
   {
-    mutex_unlock(&dev->mutex);
-    return -ENOMEM;
-  }
-
-  ret = copy_from_user(input_buffer, buffer, count);
-  if (ret)
-  {
-    kfree(input_buffer);
-    mutex_unlock(&dev->mutex);
     return -EFAULT;
   }
 
   input_buffer[count] = '\0'; // Null-terminate the string
 
-  ret = kstrtoint(input_buffer, 10, &dev->dice_count);
-  if (ret)
+  // "<dice>" or "<dice> <sides>"
+  parsed = sscanf(input_buffer, "%d %d", &dice_count, &side_count);
+  if (parsed < 1)
   {
-    kfree(input_buffer);
-    mutex_unlock(&dev->mutex);
     return -EINVAL;
   }
-
-  kfree(input_buffer);
-  mutex_unlock(&dev->mutex);
+  if (parsed == 2)
+  {
+    if (side_count < 1 || side_count > MAX_SIDE_COUNT)
+    {
+      return -EINVAL;
+    }
+    WRITE_ONCE(state->side_count, side_count);
+  }
+  WRITE_ONCE(state->dice_count, dice_count);
 
   return count;
 }
 
-static void
+long generic_dice_write(struct file* file, const char __user* buffer, size_t count, loff_t* offset)
+{
+  return dice_file_write_done(file, set_dice_shape(file->private_data, buffer, count, offset));
+}
+
+// binary bulk mode: packed rolls straight into the user buffer, no text and no allocation
+long generic_dice_ioctl(struct file* file, unsigned int cmd, unsigned long arg)
+{
+  struct dice_file* state = file->private_data;
+
+  return dice_bulk_ioctl(cmd, arg, READ_ONCE(state->side_count));
+}
+
+// zero-copy mode: map a per-open ring the kernel keeps topped up with rolls
+int generic_dice_mmap(struct file* file, struct vm_area_struct* vma)
+{
+  struct dice_file* state = file->private_data;
+
+  return dice_ring_mmap(state, vma, READ_ONCE(state->side_count));
+}
+
+__poll_t generic_dice_poll(struct file* file, poll_table* wait)
+{
+  return dice_ring_poll(file, wait);
+}
+
+static int
 roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values, int side_count)
 {
+  u8 rolls[MAX_DICE_COUNT];
+
   if (dice_count < 1 || dice_count > MAX_DICE_COUNT)
   {
     *total_len += sprintf(output_buffer + *total_len, "Invalid dice count\n");
-    return;
+    return 0;
   }
+  dice_bulk_fill(rolls, dice_count, side_count);
   for (int i = 0; i < dice_count; i++)
   {
-    dice_values[i] = get_random_u32() % side_count + 1;
+    dice_values[i] = rolls[i];
   }
 
   for (int i = 0; i < dice_count; i++)
@@ -133,4 +131,5 @@ roll_dice(char* output_buffer, int* total_len, int dice_count, int* dice_values,
   }
 
   *total_len += sprintf(output_buffer + *total_len, "\n");
+  return dice_count;
 }
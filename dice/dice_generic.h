@@ -2,21 +2,22 @@
 #define DICE_GENERIC_H
 
 #include <linux/cdev.h>
-#include <linux/mutex.h>
+#include <linux/poll.h>
 
 struct generic_dice_device
 {
   int side_count;
   struct cdev cdev;
-  struct mutex mutex;
   int dice_count;
-  int* dice_values;
 };
 
 int generic_dice_open(struct inode* inode, struct file* file);
 int generic_dice_release(struct inode* inode, struct file* file);
 long generic_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset);
 long generic_dice_write(struct file* file, const char __user* buffer, size_t count, loff_t* offset);
+long generic_dice_ioctl(struct file* file, unsigned int cmd, unsigned long arg);
+int generic_dice_mmap(struct file* file, struct vm_area_struct* vma);
+__poll_t generic_dice_poll(struct file* file, poll_table* wait);
 
 static struct file_operations generic_dice_fops = {
     .owner = THIS_MODULE,
@@ -24,6 +25,10 @@ static struct file_operations generic_dice_fops = {
     .release = generic_dice_release,
     .read = generic_dice_read,
     .write = generic_dice_write,
+    .unlocked_ioctl = generic_dice_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .mmap = generic_dice_mmap,
+    .poll = generic_dice_poll,
 };
 
 #endif // DICE_GENERIC_H
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef DICE_IOCTL_H
+#define DICE_IOCTL_H
+
+// Shared between the module and userspace: binary bulk-roll interface for /dev/dice0..2.
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define DICE_IOC_MAGIC 'D'
+
+// Fill `buffer` with `count` packed rolls, one byte per die, values 1..sides.
+// `sides` = 0 uses the device's own side count. The ioctl returns the number of rolls written,
+// which is short of `count` only when a signal interrupts a large request.
+struct dice_bulk_request
+{
+  __u64 buffer;
+  __u64 count;
+  __u32 sides;
+  __u32 reserved;
+};
+
+#define DICE_IOC_BULK_ROLL _IOW(DICE_IOC_MAGIC, 1, struct dice_bulk_request)
+
+#define DICE_BULK_MAX_SIDES 255
+
+// mmap'd roll ring, one per open file. Map DICE_RING_MAP_SIZE(page size) bytes at offset 0:
+// the first page holds this header, the rolls follow at data_offset.
+// The kernel produces at head, userspace consumes at tail; both are free-running counters,
+// slot = counter & (size - 1). Load head with acquire and publish tail with release.
+// When fewer than low_watermark rolls remain, poll() schedules a refill and POLLIN is raised
+// once rolls are available again.
+struct dice_ring_header
+{
+  __u32 head; // written by the kernel
+  __u32 pad0[15];
+  __u32 tail; // written by userspace
+  __u32 pad1[15];
+  __u32 size;
+  __u32 low_watermark;
+  __u32 data_offset;
+  __u32 sides;
+};
+
+#define DICE_RING_SLOTS 65536
+#define DICE_RING_MAP_SIZE(page_size) ((page_size) + DICE_RING_SLOTS)
+
+#endif // DICE_IOCTL_H
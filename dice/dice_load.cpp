@@ -0,0 +1,215 @@
+#include "dice_ioctl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Closed-loop load generator: N threads hammer one device until the time is up, then client-side
+// ops/s is printed next to the module's own per-CPU counters from /sys/class/dice_class, sampled
+// before and after, so the two can be checked against each other.
+namespace
+{
+const char* const kCounters[] = {"opens", "reads", "writes", "ioctls", "rolls", "bytes", "errors"};
+constexpr size_t kCounterCount = sizeof(kCounters) / sizeof(kCounters[0]);
+
+struct Sample
+{
+  uint64_t values[kCounterCount] = {};
+  bool available = true;
+};
+
+Sample sample_counters(const std::string& dir)
+{
+  Sample sample;
+  for (size_t i = 0; i < kCounterCount; ++i)
+  {
+    std::ifstream in(dir + "/" + kCounters[i]);
+    if (!(in >> sample.values[i]))
+    {
+      sample.available = false;
+    }
+  }
+  return sample;
+}
+
+// The open mode's operation: open, one read, close.
+bool run_open(const std::string& path, std::vector<char>& buffer)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  bool ok = ::read(fd, buffer.data(), buffer.size()) > 0;
+  ::close(fd);
+  return ok;
+}
+
+void worker(const std::string& mode,
+            const std::string& path,
+            size_t batch,
+            const std::atomic<bool>& stop,
+            uint64_t& ops,
+            uint64_t& failures)
+{
+  std::vector<char> buffer(std::max<size_t>(batch, 4096));
+  int fd = mode == "open" ? -1 : ::open(path.c_str(), O_RDWR);
+  if (mode != "open" && fd < 0)
+  {
+    std::perror(path.c_str());
+    ++failures;
+    return;
+  }
+
+  dice_bulk_request req{};
+  req.buffer = reinterpret_cast<uintptr_t>(buffer.data());
+  req.count = batch;
+
+  while (!stop.load(std::memory_order_relaxed))
+  {
+    bool ok;
+    if (mode == "open")
+    {
+      ok = run_open(path, buffer);
+    }
+    else if (mode == "read")
+    {
+      ok = ::pread(fd, buffer.data(), buffer.size(), 0) > 0;
+    }
+    else
+    {
+      ok = ::ioctl(fd, DICE_IOC_BULK_ROLL, &req) >= 0;
+    }
+    ++ops;
+    failures += !ok;
+  }
+  if (fd >= 0)
+  {
+    ::close(fd);
+  }
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--device PATH] [--mode open|read|ioctl] [--threads N] [--seconds S]"
+               " [--batch ROLLS] [--sysfs DIR]\n"
+               "open: open+read+close per op, read: pread on one fd per thread,"
+               " ioctl: bulk rolls of --batch dice.\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string path = "/dev/dice0";
+  std::string mode = "read";
+  std::string sysfs = "/sys/class/dice_class";
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  double seconds = 5;
+  size_t batch = 4096;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (i + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    std::string value = argv[++i];
+    if (arg == "--device")
+    {
+      path = value;
+    }
+    else if (arg == "--mode")
+    {
+      mode = value;
+    }
+    else if (arg == "--threads")
+    {
+      threads = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+    }
+    else if (arg == "--seconds")
+    {
+      seconds = std::stod(value);
+    }
+    else if (arg == "--batch")
+    {
+      batch = std::max<size_t>(1, std::stoul(value));
+    }
+    else if (arg == "--sysfs")
+    {
+      sysfs = value;
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (mode != "open" && mode != "read" && mode != "ioctl")
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<uint64_t> ops(threads * 8);      // one slot per cache line
+  std::vector<uint64_t> failures(threads * 8);
+  std::vector<std::thread> pool;
+
+  Sample before = sample_counters(sysfs);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    pool.emplace_back(worker, mode, path, batch, std::cref(stop), std::ref(ops[t * 8]),
+                      std::ref(failures[t * 8]));
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& thread : pool)
+  {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  Sample after = sample_counters(sysfs);
+  double elapsed = std::chrono::duration<double>(end - start).count();
+
+  uint64_t total_ops = 0;
+  uint64_t total_failures = 0;
+  for (unsigned t = 0; t < threads; ++t)
+  {
+    total_ops += ops[t * 8];
+    total_failures += failures[t * 8];
+  }
+
+  std::cout << mode << " on " << path << ", " << threads << " thread(s), " << std::fixed
+            << std::setprecision(2) << elapsed << " s\n"
+            << "  client: " << total_ops << " ops, " << total_ops / elapsed / 1e3
+            << " K ops/s, " << total_failures << " failures\n";
+  if (!before.available || !after.available)
+  {
+    std::cout << "  module counters not found under " << sysfs << '\n';
+    return total_failures ? 1 : 0;
+  }
+  std::cout << "  module:";
+  for (size_t i = 0; i < kCounterCount; ++i)
+  {
+    uint64_t delta = after.values[i] - before.values[i];
+    std::cout << ' ' << kCounters[i] << ' ' << delta << " (" << std::setprecision(1)
+              << delta / elapsed / 1e3 << " K/s)";
+  }
+  std::cout << std::defaultfloat << std::setprecision(6) << '\n';
+  return total_failures ? 1 : 0;
+}
@@ -1,23 +1,24 @@
 #ifndef DICE_REGULAR_H
 #define DICE_REGULAR_H
 
-#include <linux/mutex.h>
 #include <linux/cdev.h>
+#include <linux/poll.h>
 
 #define REGULAR_DICE_SIDECOUNT 6
 
 struct regular_dice_device
 {
   struct cdev cdev;
-  struct mutex mutex;
   int dice_count;
-  int* dice_values;
 };
 
 int regular_dice_open(struct inode* inode, struct file* file);
 int regular_dice_release(struct inode* inode, struct file* file);
 long regular_dice_read(struct file* file, char __user* buffer, size_t count, loff_t* offset);
 long regular_dice_write(struct file* file, const char __user* buffer, size_t count, loff_t* offset);
+long regular_dice_ioctl(struct file* file, unsigned int cmd, unsigned long arg);
+int regular_dice_mmap(struct file* file, struct vm_area_struct* vma);
+__poll_t regular_dice_poll(struct file* file, poll_table* wait);
 
 static struct file_operations regular_dice_fops = {
     .owner = THIS_MODULE,
@@ -25,6 +26,10 @@ static struct file_operations regular_dice_fops = {
     .release = regular_dice_release,
     .read = regular_dice_read,
     .write = regular_dice_write,
+    .unlocked_ioctl = regular_dice_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .mmap = regular_dice_mmap,
+    .poll = regular_dice_poll,
 };
 
 
@@ -0,0 +1,135 @@
+#include "dice_ring.h"
+#include "dice_bulk.h"
+#include "dice_ioctl.h"
+#include "dice_stats.h"
+#include <linux/mm.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+
+#define DICE_RING_LOW_WATERMARK (DICE_RING_SLOTS / 4)
+
+// Userspace owns tail, so never trust it beyond "somewhere in the last size slots".
+static u32 dice_ring_used(struct dice_ring* ring)
+{
+  u32 head = READ_ONCE(ring->header->head);
+  u32 tail = smp_load_acquire(&ring->header->tail);
+  u32 used = head - tail;
+
+  return used > DICE_RING_SLOTS ? DICE_RING_SLOTS : used;
+}
+
+// Top the ring up from head to the consumer's tail, then publish the new head.
+static void dice_ring_fill(struct dice_ring* ring)
+{
+  u32 start = ring->header->head;
+  u32 head = start;
+  u32 free = DICE_RING_SLOTS - dice_ring_used(ring);
+
+  while (free)
+  {
+    u32 slot = head & (DICE_RING_SLOTS - 1);
+    u32 run = min_t(u32, free, DICE_RING_SLOTS - slot);
+
+    dice_bulk_fill(ring->data + slot, run, ring->sides);
+    head += run;
+    free -= run;
+  }
+
+  dice_stat_add(rolls, head - start);
+  smp_store_release(&ring->header->head, head);
+}
+
+static void dice_ring_refill_work(struct work_struct* work)
+{
+  struct dice_ring* ring = container_of(work, struct dice_ring, refill);
+
+  dice_ring_fill(ring);
+  wake_up_interruptible(&ring->wait);
+}
+
+static struct dice_ring* dice_ring_create(unsigned int sides)
+{
+  struct dice_ring* ring;
+
+  ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+  if (!ring)
+  {
+    return NULL;
+  }
+
+  ring->header = vmalloc_user(DICE_RING_MAP_SIZE(PAGE_SIZE));
+  if (!ring->header)
+  {
+    kfree(ring);
+    return NULL;
+  }
+  ring->data = (u8*)ring->header + PAGE_SIZE;
+  ring->sides = sides;
+  ring->header->size = DICE_RING_SLOTS;
+  ring->header->low_watermark = DICE_RING_LOW_WATERMARK;
+  ring->header->data_offset = PAGE_SIZE;
+  ring->header->sides = sides;
+  INIT_WORK(&ring->refill, dice_ring_refill_work);
+  init_waitqueue_head(&ring->wait);
+
+  dice_ring_fill(ring);
+  return ring;
+}
+
+void dice_ring_destroy(struct dice_ring* ring)
+{
+  cancel_work_sync(&ring->refill);
+  vfree(ring->header);
+  kfree(ring);
+}
+
+int dice_ring_mmap(struct dice_file* state, struct vm_area_struct* vma, unsigned int sides)
+{
+  struct dice_ring* ring;
+  struct dice_ring* old;
+
+  if (vma->vm_pgoff || vma->vm_end - vma->vm_start != DICE_RING_MAP_SIZE(PAGE_SIZE))
+  {
+    return -EINVAL;
+  }
+
+  ring = READ_ONCE(state->ring);
+  if (!ring)
+  {
+    ring = dice_ring_create(sides);
+    if (!ring)
+    {
+      return -ENOMEM;
+    }
+    // Two racing mmaps on the same file: keep the first ring.
+    old = cmpxchg(&state->ring, NULL, ring);
+    if (old)
+    {
+      dice_ring_destroy(ring);
+      ring = old;
+    }
+  }
+
+  return remap_vmalloc_range(vma, ring->header, 0);
+}
+
+__poll_t dice_ring_poll(struct file* file, poll_table* wait)
+{
+  struct dice_file* state = file->private_data;
+  struct dice_ring* ring = READ_ONCE(state->ring);
+  u32 used;
+
+  // Without a ring the text read path is always ready.
+  if (!ring)
+  {
+    return EPOLLIN | EPOLLRDNORM;
+  }
+
+  poll_wait(file, &ring->wait, wait);
+  used = dice_ring_used(ring);
+  if (used <= DICE_RING_LOW_WATERMARK)
+  {
+    schedule_work(&ring->refill);
+  }
+  return used ? EPOLLIN | EPOLLRDNORM : 0;
+}
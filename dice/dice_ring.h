@@ -0,0 +1,24 @@
+#ifndef DICE_RING_H
+#define DICE_RING_H
+
+#include "dice_file.h"
+#include <linux/fs.h>
+#include <linux/mm_types.h>
+#include <linux/poll.h>
+#include <linux/wait.h>
+#include <linux/workqueue.h>
+
+struct dice_ring
+{
+  struct dice_ring_header* header; // vmalloc_user'd, header page followed by the rolls
+  u8* data;
+  unsigned int sides;
+  struct work_struct refill;
+  wait_queue_head_t wait;
+};
+
+int dice_ring_mmap(struct dice_file* state, struct vm_area_struct* vma, unsigned int sides);
+__poll_t dice_ring_poll(struct file* file, poll_table* wait);
+void dice_ring_destroy(struct dice_ring* ring);
+
+#endif // DICE_RING_H
@@ -0,0 +1,141 @@
+#ifndef DICE_RING_READER_HPP
+#define DICE_RING_READER_HPP
+
+#include "dice_ioctl.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+
+// Userspace side of the mmap'd roll ring: rolls are consumed straight out of shared memory and
+// the only syscall is a poll() once per refill.
+class DiceRingReader
+{
+private:
+  int fd = -1;
+  size_t map_size = 0;
+  void* mapping = nullptr;
+  dice_ring_header* header = nullptr;
+  const uint8_t* data = nullptr;
+  uint32_t mask = 0;
+  uint32_t tail = 0;
+  uint32_t head = 0;  // last head we observed
+  bool kicked = false; // refill already requested since the last low-watermark crossing
+
+  void wait_for_rolls()
+  {
+    pollfd pfd{fd, POLLIN, 0};
+    while (true)
+    {
+      head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+      if (head != tail)
+      {
+        return;
+      }
+      if (::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+      {
+        throw std::system_error(errno, std::generic_category(), "poll");
+      }
+    }
+  }
+
+  // Cheap non-blocking poll so the kernel starts refilling before we run dry.
+  void kick_refill()
+  {
+    pollfd pfd{fd, POLLIN, 0};
+    ::poll(&pfd, 1, 0);
+    kicked = true;
+  }
+
+public:
+  explicit DiceRingReader(const char* path)
+  {
+    fd = ::open(path, O_RDWR);
+    if (fd < 0)
+    {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    map_size = DICE_RING_MAP_SIZE(static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+    mapping = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "mmap");
+    }
+    header = static_cast<dice_ring_header*>(mapping);
+    data = static_cast<const uint8_t*>(mapping) + header->data_offset;
+    mask = header->size - 1;
+    tail = header->tail;
+    head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+  }
+
+  DiceRingReader(const DiceRingReader&) = delete;
+  DiceRingReader& operator=(const DiceRingReader&) = delete;
+
+  ~DiceRingReader()
+  {
+    ::munmap(mapping, map_size);
+    ::close(fd);
+  }
+
+  unsigned int sides() const
+  {
+    return header->sides;
+  }
+
+  // Copy up to n rolls into out, blocking only when the ring is empty. Returns n.
+  size_t read(uint8_t* out, size_t n)
+  {
+    size_t done = 0;
+    while (done < n)
+    {
+      if (head == tail)
+      {
+        head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+          wait_for_rolls();
+        }
+        kicked = false;
+      }
+
+      uint32_t avail = head - tail;
+      uint32_t slot = tail & mask;
+      uint32_t run = mask + 1 - slot;
+      if (run > avail)
+      {
+        run = avail;
+      }
+      if (run > n - done)
+      {
+        run = static_cast<uint32_t>(n - done);
+      }
+      std::memcpy(out + done, data + slot, run);
+      done += run;
+      tail += run;
+      __atomic_store_n(&header->tail, tail, __ATOMIC_RELEASE);
+
+      if (!kicked && head - tail <= header->low_watermark)
+      {
+        kick_refill();
+      }
+    }
+    return done;
+  }
+
+  uint8_t next()
+  {
+    uint8_t roll;
+    read(&roll, 1);
+    return roll;
+  }
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef DICE_ROLL_H
+#define DICE_ROLL_H
+
+// Unbiased dice from 32-bit random words, shared by the module and the userspace library.
+//
+// Lemire-style multiply-shift, batched: for k dice with `sides` faces each, P = sides^k <= 2^32.
+// Multiplying the word by sides takes the next die from the high half and leaves the low half
+// as the fraction for the one after, so a single word yields k dice. This is the mixed-radix
+// expansion of floor(word * P / 2^32), which is exact once words whose final low half falls
+// below 2^32 mod P are rejected. The modulo is paid once, at init.
+//
+// k ranges from 12 dice per word for d6 down to 4 per word for d100.
+
+#include <linux/types.h>
+
+#define DICE_ROLL_MAX_PER_WORD 32
+
+struct dice_roller
+{
+  __u32 sides;
+  __u32 per_word;
+  __u32 threshold; // 2^32 mod sides^per_word; lower leftovers are rejected
+};
+
+static inline void dice_roller_init(struct dice_roller* roller, unsigned int sides)
+{
+  __u64 product = 1;
+  __u32 per_word = 0;
+
+  while (per_word < DICE_ROLL_MAX_PER_WORD && product * sides <= (1ULL << 32))
+  {
+    product *= sides;
+    per_word++;
+  }
+
+  roller->sides = sides;
+  roller->per_word = per_word;
+  roller->threshold = (__u32)(((1ULL << 32) - product) % product);
+}
+
+// Writes roller->per_word dice (1..sides) to out. Returns 0 if the word must be rejected, in which
+// case out holds garbage and the caller draws another word.
+static inline int dice_roller_extract(const struct dice_roller* roller, __u32 word, __u8* out)
+{
+  for (__u32 i = 0; i < roller->per_word; i++)
+  {
+    __u64 m = (__u64)word * roller->sides;
+    out[i] = (__u8)((m >> 32) + 1);
+    word = (__u32)m;
+  }
+  return word >= roller->threshold;
+}
+
+#endif // DICE_ROLL_H
@@ -0,0 +1,69 @@
+#ifndef DICE_ROLLER_HPP
+#define DICE_ROLLER_HPP
+
+#include "dice_roll.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+// Userspace front end for the module's roll engine: same unbiased multi-dice-per-word extraction,
+// fed by any 32-bit URBG.
+template <typename URBG = std::mt19937> class DiceRoller
+{
+  static_assert(URBG::min() == 0 && URBG::max() == 0xffffffffu, "DiceRoller needs 32-bit words");
+
+private:
+  dice_roller roller;
+  URBG gen;
+  uint8_t spare[DICE_ROLL_MAX_PER_WORD];
+  uint32_t spare_left = 0;
+
+public:
+  explicit DiceRoller(unsigned int sides, typename URBG::result_type seed = URBG::default_seed)
+      : gen(seed)
+  {
+    dice_roller_init(&roller, sides);
+  }
+
+  unsigned int sides() const
+  {
+    return roller.sides;
+  }
+
+  unsigned int per_word() const
+  {
+    return roller.per_word;
+  }
+
+  void fill(uint8_t* dst, size_t count)
+  {
+    size_t produced = 0;
+    while (count - produced >= roller.per_word)
+    {
+      if (dice_roller_extract(&roller, static_cast<uint32_t>(gen()), dst + produced))
+      {
+        produced += roller.per_word;
+      }
+    }
+    while (produced < count)
+    {
+      dst[produced++] = roll();
+    }
+  }
+
+  uint8_t roll()
+  {
+    while (spare_left == 0)
+    {
+      if (dice_roller_extract(&roller, static_cast<uint32_t>(gen()), spare))
+      {
+        spare_left = roller.per_word;
+      }
+    }
+    return spare[--spare_left];
+  }
+};
+
+#endif
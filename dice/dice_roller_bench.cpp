@@ -0,0 +1,99 @@
+#include "dice_roller.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr size_t kRolls = 100000000;
+constexpr size_t kBatch = 4096;
+constexpr size_t kUniformRolls = 60000000;
+
+// What roll_dice used to do: one full 32-bit draw and a biased modulo per die.
+void naive_fill(std::mt19937& gen, uint8_t* dst, size_t count, unsigned int sides)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    dst[i] = static_cast<uint8_t>(gen() % sides + 1);
+  }
+}
+
+template <typename Fill> double time_fill(Fill&& fill)
+{
+  std::vector<uint8_t> buffer(kBatch);
+  uint64_t sum = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t done = 0; done < kRolls; done += kBatch)
+  {
+    fill(buffer.data(), kBatch);
+    sum += buffer[0];
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  if (sum == 0)
+  {
+    std::cerr << "no rolls produced\n";
+  }
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// Pearson chi-square against the uniform distribution, compared to the p = 0.001 critical value
+// (Wilson-Hilferty approximation).
+bool check_uniform(DiceRoller<>& roller)
+{
+  unsigned int sides = roller.sides();
+  std::vector<uint64_t> counts(sides + 1, 0);
+  std::vector<uint8_t> buffer(kBatch);
+  for (size_t done = 0; done < kUniformRolls; done += kBatch)
+  {
+    roller.fill(buffer.data(), kBatch);
+    for (uint8_t roll : buffer)
+    {
+      ++counts[roll];
+    }
+  }
+
+  double expected = static_cast<double>(kUniformRolls) / sides;
+  double chi2 = 0;
+  bool in_range = counts[0] == 0;
+  for (unsigned int face = 1; face <= sides; ++face)
+  {
+    double diff = counts[face] - expected;
+    chi2 += diff * diff / expected;
+  }
+  double dof = sides - 1;
+  double z = 3.09; // one-sided 0.999 quantile of N(0, 1)
+  double critical = dof * std::pow(1 - 2 / (9 * dof) + z * std::sqrt(2 / (9 * dof)), 3);
+
+  std::cout << "  d" << sides << ": chi2 = " << chi2 << " (critical " << critical << ", " << dof
+            << " dof) " << (in_range && chi2 < critical ? "uniform" : "NOT uniform") << std::endl;
+  return in_range && chi2 < critical;
+}
+} // namespace
+
+int main()
+{
+  std::cout << "Throughput (" << kRolls << " rolls):" << std::endl;
+  for (unsigned int sides : {6u, 50u, 100u})
+  {
+    std::mt19937 gen;
+    DiceRoller<> roller(sides);
+    double naive = time_fill([&](uint8_t* dst, size_t n) { naive_fill(gen, dst, n, sides); });
+    double batched = time_fill([&](uint8_t* dst, size_t n) { roller.fill(dst, n); });
+    std::cout << "  d" << sides << ": modulo " << kRolls / naive / 1e6 << " M/s, batched "
+              << kRolls / batched / 1e6 << " M/s (" << roller.per_word() << " dice per word)"
+              << std::endl;
+  }
+
+  std::cout << "Uniformity (" << kUniformRolls << " rolls):" << std::endl;
+  bool uniform = true;
+  for (unsigned int sides : {2u, 6u, 50u, 100u, 255u})
+  {
+    DiceRoller<> roller(sides, 42);
+    uniform = check_uniform(roller) && uniform;
+  }
+  return uniform ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include "dice_stats.h"
+#include <linux/cpumask.h>
+#include <linux/stddef.h>
+#include <linux/sysfs.h>
+
+#define CREATE_TRACE_POINTS
+#include "dice_trace.h"
+
+DEFINE_PER_CPU(struct dice_stats, dice_stats);
+
+// Sums one field over every CPU. Readers may see a count mid-update on another CPU, which is
+// fine for monotonic counters sampled by tools.
+static u64 dice_stats_sum(size_t offset)
+{
+  u64 sum = 0;
+  int cpu;
+
+  for_each_possible_cpu(cpu)
+  {
+    sum += *(u64*)((char*)per_cpu_ptr(&dice_stats, cpu) + offset);
+  }
+  return sum;
+}
+
+#define DICE_STAT_ATTR(field)                                                                    \
+  static ssize_t field##_show(const struct class* cls, const struct class_attribute* attr,      \
+                              char* buf)                                                         \
+  {                                                                                              \
+    return sysfs_emit(buf, "%llu\n", dice_stats_sum(offsetof(struct dice_stats, field)));      \
+  }                                                                                              \
+  static CLASS_ATTR_RO(field)
+
+DICE_STAT_ATTR(opens);
+DICE_STAT_ATTR(reads);
+DICE_STAT_ATTR(writes);
+DICE_STAT_ATTR(ioctls);
+DICE_STAT_ATTR(rolls);
+DICE_STAT_ATTR(bytes);
+DICE_STAT_ATTR(errors);
+
+static const struct class_attribute* dice_stat_attrs[] = {
+    &class_attr_opens, &class_attr_reads, &class_attr_writes, &class_attr_ioctls,
+    &class_attr_rolls, &class_attr_bytes, &class_attr_errors,
+};
+
+int dice_stats_register(struct class* cls)
+{
+  int ret;
+
+  for (int i = 0; i < ARRAY_SIZE(dice_stat_attrs); i++)
+  {
+    ret = class_create_file(cls, dice_stat_attrs[i]);
+    if (ret)
+    {
+      while (i--)
+      {
+        class_remove_file(cls, dice_stat_attrs[i]);
+      }
+      return ret;
+    }
+  }
+  return 0;
+}
+
+void dice_stats_unregister(struct class* cls)
+{
+  for (int i = 0; i < ARRAY_SIZE(dice_stat_attrs); i++)
+  {
+    class_remove_file(cls, dice_stat_attrs[i]);
+  }
+}
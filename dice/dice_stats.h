@@ -0,0 +1,29 @@
+#ifndef DICE_STATS_H
+#define DICE_STATS_H
+
+#include <linux/device.h>
+#include <linux/percpu.h>
+#include <linux/types.h>
+
+// Module-wide event counters, one copy per CPU so updating one is a single this_cpu_add with no
+// shared cache line. Reading /sys/class/dice_class/<counter> sums the copies.
+struct dice_stats
+{
+  u64 opens;
+  u64 reads;
+  u64 writes;
+  u64 ioctls;
+  u64 rolls;  // dice delivered: copied out by read and the bulk ioctl, or published to a ring
+  u64 bytes;  // copied to userspace by read and the bulk ioctl
+  u64 errors; // read, write and ioctl calls that failed
+};
+
+DECLARE_PER_CPU(struct dice_stats, dice_stats);
+
+#define dice_stat_add(field, n) this_cpu_add(dice_stats.field, (n))
+#define dice_stat_inc(field) this_cpu_inc(dice_stats.field)
+
+int dice_stats_register(struct class* cls);
+void dice_stats_unregister(struct class* cls);
+
+#endif // DICE_STATS_H
@@ -0,0 +1,55 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM dice
+
+#if !defined(DICE_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define DICE_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// Static tracepoints under /sys/kernel/tracing/events/dice/. They compile to a patched-out
+// branch until enabled, so they cost nothing on the fast path otherwise.
+
+TRACE_EVENT(dice_read,
+            TP_PROTO(int minor, int dice_count, int side_count, long ret),
+            TP_ARGS(minor, dice_count, side_count, ret),
+            TP_STRUCT__entry(__field(int, minor) __field(int, dice_count) __field(int, side_count)
+                                 __field(long, ret)),
+            TP_fast_assign(__entry->minor = minor; __entry->dice_count = dice_count;
+                           __entry->side_count = side_count;
+                           __entry->ret = ret;),
+            TP_printk("dice%d count=%d sides=%d ret=%ld",
+                      __entry->minor,
+                      __entry->dice_count,
+                      __entry->side_count,
+                      __entry->ret));
+
+TRACE_EVENT(dice_write,
+            TP_PROTO(int minor, int dice_count, int side_count, long ret),
+            TP_ARGS(minor, dice_count, side_count, ret),
+            TP_STRUCT__entry(__field(int, minor) __field(int, dice_count) __field(int, side_count)
+                                 __field(long, ret)),
+            TP_fast_assign(__entry->minor = minor; __entry->dice_count = dice_count;
+                           __entry->side_count = side_count;
+                           __entry->ret = ret;),
+            TP_printk("dice%d count=%d sides=%d ret=%ld",
+                      __entry->minor,
+                      __entry->dice_count,
+                      __entry->side_count,
+                      __entry->ret));
+
+// One batch of rolls from the shared engine, whichever path asked for it.
+TRACE_EVENT(dice_roll,
+            TP_PROTO(size_t count, unsigned int sides),
+            TP_ARGS(count, sides),
+            TP_STRUCT__entry(__field(size_t, count) __field(unsigned int, sides)),
+            TP_fast_assign(__entry->count = count; __entry->sides = sides;),
+            TP_printk("count=%zu sides=%u", __entry->count, __entry->sides));
+
+#endif // DICE_TRACE_H
+
+// define_trace.h includes this header again by path; the Makefile puts $(src) on the path.
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE dice_trace
+#include <trace/define_trace.h>
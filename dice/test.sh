@@ -2,9 +2,20 @@ sudo rmmod dice_module
 sudo insmod ./dice_module.ko common_sides=50
 ls -l /dev | grep dice
 
-echo 3 | sudo tee /dev/dice0
-sudo cat /dev/dice0
-echo 3 | sudo tee /dev/dice1
-sudo cat /dev/dice1
-echo 3 | sudo tee /dev/dice2
-sudo cat /dev/dice2
\ No newline at end of file
+# dice count is per open file, so write and read through the same descriptor
+
+sudo sh -c 'exec 3<>/dev/dice0; echo 3 >&3; cat <&3'
+sudo sh -c 'exec 3<>/dev/dice1; echo 3 >&3; cat <&3'
+sudo sh -c 'exec 3<>/dev/dice2; echo 3 >&3; cat <&3'
+sudo sh -c 'exec 3<>/dev/dice2; echo "3 20" >&3; cat <&3'
+
+make bench
+./dice_bench /dev/dice0
+./dice_bench /dev/dice2
+./dice_roller_bench
+
+# module-wide counters and tracepoints
+grep . /sys/class/dice_class/{opens,reads,writes,ioctls,rolls,bytes,errors}
+sudo sh -c 'echo 1 > /sys/kernel/tracing/events/dice/enable; cat /dev/dice2 > /dev/null; tail -n 3 /sys/kernel/tracing/trace; echo 0 > /sys/kernel/tracing/events/dice/enable'
+./dice_load --mode open --seconds 3
+./dice_load --mode ioctl --seconds 3
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed-capacity, never-allocating replacement for std::function.
+// The callable is stored in an inline buffer of Capacity bytes; anything larger is rejected at
+// compile time instead of silently spilling to the heap.
+// Copyable = false gives a move-only wrapper that also accepts move-only callables.
+
+constexpr std::size_t kInplaceDefaultCapacity = 32;
+
+template <typename Signature,
+          std::size_t Capacity = kInplaceDefaultCapacity,
+          std::size_t Alignment = alignof(std::max_align_t),
+          bool Copyable = true>
+class basic_inplace_function;
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment, bool Copyable>
+class basic_inplace_function<R(Args...), Capacity, Alignment, Copyable>
+{
+private:
+  struct vtable
+  {
+    R (*invoke)(void* obj, Args&&... args);
+    void (*copy)(void* dst, const void* src);
+    void (*move)(void* dst, void* src);
+    void (*destroy)(void* obj);
+  };
+
+  template <typename F> static R invoke_impl(void* obj, Args&&... args)
+  {
+    return std::invoke(*static_cast<F*>(obj), std::forward<Args>(args)...);
+  }
+
+  template <typename F> static void copy_impl(void* dst, const void* src)
+  {
+    if constexpr (Copyable)
+    {
+      ::new (dst) F(*static_cast<const F*>(src));
+    }
+  }
+
+  template <typename F> static void move_impl(void* dst, void* src)
+  {
+    ::new (dst) F(std::move(*static_cast<F*>(src)));
+    static_cast<F*>(src)->~F();
+  }
+
+  template <typename F> static void destroy_impl(void* obj)
+  {
+    static_cast<F*>(obj)->~F();
+  }
+
+  template <typename F> static constexpr vtable vtable_for = {
+      &invoke_impl<F>, &copy_impl<F>, &move_impl<F>, &destroy_impl<F>};
+
+  alignas(Alignment) unsigned char storage[Capacity];
+  const vtable* vptr = nullptr;
+
+  // The copy operations below take this type, so a move-only wrapper declares none and the
+  // declared move constructor leaves its implicit copies deleted: is_copy_constructible is false
+  // and generic code sees that, rather than a copy constructor that fails when instantiated.
+  struct no_copy
+  {
+  };
+  using copy_source = std::conditional_t<Copyable, basic_inplace_function, no_copy>;
+
+  template <typename D>
+  static constexpr bool stores = sizeof(D) <= Capacity && Alignment % alignof(D) == 0 &&
+                                 std::is_nothrow_move_constructible_v<D> &&
+                                 (!Copyable || std::is_copy_constructible_v<D>);
+
+public:
+  static constexpr std::size_t capacity = Capacity;
+  static constexpr std::size_t alignment = Alignment;
+
+  basic_inplace_function() noexcept = default;
+  basic_inplace_function(std::nullptr_t) noexcept {};
+
+  // Accepts a callable only if it fits the buffer and its alignment, is nothrow movable, and is
+  // copyable when the wrapper is, so std::is_constructible and overload resolution see exactly
+  // the callables that would compile.
+  template <typename F,
+            typename D = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same_v<D, basic_inplace_function> &&
+                                        std::is_invocable_r_v<R, D&, Args...> && stores<D>>>
+  basic_inplace_function(F&& f)
+  {
+    if constexpr (std::is_pointer_v<std::remove_reference_t<F>> || std::is_member_pointer_v<D>)
+    {
+      // A null function pointer gives an empty wrapper, as with std::function.
+      if (f == nullptr)
+      {
+        return;
+      }
+    }
+    ::new (static_cast<void*>(storage)) D(std::forward<F>(f));
+    vptr = &vtable_for<D>;
+  }
+
+  basic_inplace_function(const copy_source& other)
+  {
+    if (other.vptr)
+    {
+      other.vptr->copy(storage, other.storage);
+      vptr = other.vptr;
+    }
+  }
+
+  basic_inplace_function(basic_inplace_function&& other) noexcept
+  {
+    if (other.vptr)
+    {
+      other.vptr->move(storage, other.storage);
+      vptr = other.vptr;
+      other.vptr = nullptr;
+    }
+  }
+
+  basic_inplace_function& operator=(const copy_source& other)
+  {
+    if (this != &other)
+    {
+      basic_inplace_function tmp(other);
+      *this = std::move(tmp);
+    }
+    return *this;
+  }
+
+  basic_inplace_function& operator=(basic_inplace_function&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      if (other.vptr)
+      {
+        other.vptr->move(storage, other.storage);
+        vptr = other.vptr;
+        other.vptr = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  basic_inplace_function& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  ~basic_inplace_function()
+  {
+    reset();
+  }
+
+  void reset() noexcept
+  {
+    if (vptr)
+    {
+      vptr->destroy(storage);
+      vptr = nullptr;
+    }
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return vptr != nullptr;
+  }
+
+  // Calling an empty wrapper is undefined, same as dereferencing a null function pointer; we do
+  // not throw std::bad_function_call so the call path stays a single indirect jump.
+  R operator()(Args... args) const
+  {
+    return vptr->invoke(const_cast<unsigned char*>(storage), std::forward<Args>(args)...);
+  }
+};
+
+template <typename Signature, std::size_t Capacity = kInplaceDefaultCapacity>
+using inplace_function = basic_inplace_function<Signature, Capacity>;
+
+template <typename Signature, std::size_t Capacity = kInplaceDefaultCapacity>
+using inplace_move_function =
+    basic_inplace_function<Signature, Capacity, alignof(std::max_align_t), false>;
+
+// Non-owning view of a callable: two pointers, trivially copyable, constexpr-constructible.
+// The referenced callable must outlive the function_ref.
+template <typename Signature> class function_ref;
+
+template <typename R, typename... Args> class function_ref<R(Args...)>
+{
+private:
+  const void* obj = nullptr;
+  R (*thunk)(const void*, Args&&...) = nullptr;
+
+  template <typename F> static R call_object(const void* o, Args&&... args)
+  {
+    return std::invoke(*static_cast<F*>(const_cast<void*>(o)), std::forward<Args>(args)...);
+  }
+
+  template <typename Fn> static R call_pointer(const void* o, Args&&... args)
+  {
+    return std::invoke(reinterpret_cast<Fn>(const_cast<void*>(o)), std::forward<Args>(args)...);
+  }
+
+public:
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, function_ref> &&
+                                        !std::is_function_v<std::remove_reference_t<F>> &&
+                                        std::is_invocable_r_v<R, F&, Args...>>>
+  constexpr function_ref(F&& f) noexcept
+      : obj(std::addressof(f)), thunk(&call_object<std::remove_reference_t<F>>)
+  {
+  }
+
+  function_ref(R (*fn)(Args...)) noexcept
+      : obj(reinterpret_cast<const void*>(fn)), thunk(&call_pointer<R (*)(Args...)>)
+  {
+  }
+
+  R operator()(Args... args) const
+  {
+    return thunk(obj, std::forward<Args>(args)...);
+  }
+};
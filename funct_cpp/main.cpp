@@ -1,8 +1,11 @@
 #include "funct.hpp"
+#include "inplace_function.hpp"
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -13,6 +16,38 @@ void print_vec(const std::vector<int>& vec)
   std::cout << std::endl;
 }
 
+template <typename Fn> void bench_wrapper(const char* name, long a, long b, long c)
+{
+  constexpr int kIters = 1000000;
+  std::vector<Fn> fns;
+  fns.reserve(kIters);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < kIters; ++i)
+  {
+    fns.emplace_back([a, b, c, i](long x) { return x * a + b - c + i; });
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> construct = end - start;
+
+  start = std::chrono::high_resolution_clock::now();
+  std::vector<Fn> copies(fns);
+  end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> copy = end - start;
+
+  long sum = 0;
+  start = std::chrono::high_resolution_clock::now();
+  for (const auto& fn : copies)
+  {
+    sum += fn(sum & 0xff);
+  }
+  end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> invoke = end - start;
+
+  std::cout << name << ": construct " << construct.count() << " s, copy " << copy.count()
+            << " s, invoke " << invoke.count() << " s (checksum " << sum << ")" << std::endl;
+}
+
 int main()
 {
   std::vector<int> vec{1, 2, 3, 4, 5};
@@ -29,6 +64,33 @@ int main()
 
   std::sort(vec.begin(), vec.end(), [](int x, int y) { return x > y; });
   print_vec(vec);
+
+  // Same pipeline, but every stage lives in a fixed inline buffer: no allocation on construction
+  // or copy, whatever the callables capture.
+  std::vector<inplace_function<int(int)>> pipeline{adder(2), add_3, adder_lambda(1)};
+  for (const auto& stage : pipeline)
+  {
+    std::transform(vec.begin(), vec.end(), vec.begin(), stage);
+  }
+  print_vec(vec);
+
+  auto ops = std::map<std::string, inplace_function<int(int, int)>>{
+      {"+", [](int x, int y) { return x + y; }}, {"-", [](int x, int y) { return x - y; }}};
+  std::cout << ops["+"](1, 2) << " " << ops["-"](1, 2) << std::endl;
+
+  // A move-only stage can own what it captures; the wrapper moves, and never copies, it.
+  auto offset = std::make_unique<int>(10);
+  inplace_move_function<int(int)> owning = [offset = std::move(offset)](int x) {
+    return x + *offset;
+  };
+  inplace_move_function<int(int)> moved = std::move(owning);
+  std::cout << moved(5) << " " << static_cast<bool>(owning) << std::endl;
+
+  function_ref<int(int)> view = add_3;
+  std::cout << view(4) << std::endl;
+
+  bench_wrapper<std::function<long(long)>>("std::function", 3, 5, 7);
+  bench_wrapper<inplace_function<long(long)>>("inplace_function", 3, 5, 7);
   return 0;
 
   int a = 3;
@@ -0,0 +1,137 @@
+#ifndef CHASE_LEV_HPP
+#define CHASE_LEV_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque, with the C11 orderings of Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013). The owner pushes and
+// takes at the bottom without locking; thieves take from the top and only race the owner for the
+// last element. The ring doubles when full; retired rings are kept until the deque dies because a
+// thief may still be reading one.
+template <typename T>
+class ChaseLevDeque
+{
+  static_assert(std::is_trivially_copyable<T>::value, "elements are copied through atomics");
+
+private:
+  struct Ring
+  {
+    explicit Ring(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity])
+    {
+    }
+    size_t capacity() const
+    {
+      return mask + 1;
+    }
+    T get(int64_t index) const
+    {
+      return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+    }
+    void put(int64_t index, T value)
+    {
+      slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  // top and bottom are written by different threads; keep them off each other's line.
+  alignas(64) std::atomic<int64_t> top{0};
+  alignas(64) std::atomic<int64_t> bottom{0};
+  std::atomic<Ring*> ring;
+  std::vector<std::unique_ptr<Ring>> rings; // owner only
+
+  Ring* grow(Ring* old, int64_t b, int64_t t)
+  {
+    rings.push_back(std::make_unique<Ring>(old->capacity() * 2));
+    Ring* bigger = rings.back().get();
+    for (int64_t i = t; i < b; ++i)
+    {
+      bigger->put(i, old->get(i));
+    }
+    ring.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+public:
+  // capacity must be a power of two.
+  explicit ChaseLevDeque(size_t capacity = 256)
+  {
+    rings.push_back(std::make_unique<Ring>(capacity));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+  }
+
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  // Owner only.
+  void push(T value)
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Ring* r = ring.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(r->capacity()) - 1)
+    {
+      r = grow(r, b, t);
+    }
+    r->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only. Returns false when empty or when a thief won the last element.
+  bool take(T& value)
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring* r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b)
+    {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = r->get(b);
+    if (t == b)
+    {
+      bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // Any thread. Returns false when empty or when it lost a race, so callers just move on.
+  bool steal(T& value)
+  {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+    {
+      return false;
+    }
+    Ring* r = ring.load(std::memory_order_acquire);
+    value = r->get(t);
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed);
+  }
+
+  // Racy snapshot, good enough for splitting and parking heuristics.
+  int64_t size_hint() const
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+};
+
+#endif
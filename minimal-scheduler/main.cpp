@@ -0,0 +1,283 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr int kFibCutoff = 20;
+constexpr ptrdiff_t kSortCutoff = 4096;
+
+uint64_t serial_fib(int n)
+{
+  return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
+}
+
+// One task per call down to cutoff, so a cutoff of 2 measures the scheduler rather than the work.
+uint64_t fib(Scheduler& scheduler, int n, int cutoff)
+{
+  if (n < cutoff)
+  {
+    return serial_fib(n);
+  }
+  uint64_t left = 0;
+  TaskGroup group;
+  scheduler.spawn(group, [&] { left = fib(scheduler, n - 1, cutoff); });
+  uint64_t right = fib(scheduler, n - 2, cutoff);
+  scheduler.wait(group);
+  return left + right;
+}
+
+void quicksort(Scheduler& scheduler, uint32_t* first, uint32_t* last)
+{
+  if (last - first < kSortCutoff)
+  {
+    std::sort(first, last);
+    return;
+  }
+  uint32_t a = first[0];
+  uint32_t b = first[(last - first) / 2];
+  uint32_t c = last[-1];
+  uint32_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+  uint32_t* lower = std::partition(first, last, [pivot](uint32_t x) { return x < pivot; });
+  uint32_t* upper = std::partition(lower, last, [pivot](uint32_t x) { return x == pivot; });
+  TaskGroup group;
+  scheduler.spawn(group, [&] { quicksort(scheduler, first, lower); });
+  quicksort(scheduler, upper, last);
+  scheduler.wait(group);
+}
+
+template <typename F>
+double time_seconds(F&& fn)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  fn();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+std::vector<unsigned> thread_counts(unsigned max_threads)
+{
+  std::vector<unsigned> counts;
+  for (unsigned threads = 1; threads < max_threads; threads *= 2)
+  {
+    counts.push_back(threads);
+  }
+  counts.push_back(max_threads);
+  return counts;
+}
+
+void print_row(unsigned threads, double seconds, double baseline, const Scheduler& scheduler)
+{
+  SchedulerStats stats = scheduler.stats();
+  std::cout << std::setw(9) << threads << std::fixed << std::setprecision(3) << std::setw(11)
+            << seconds * 1e3 << std::setprecision(2) << std::setw(9) << baseline / seconds
+            << std::setw(11) << baseline / seconds / threads * 100 << '%' << std::setw(12)
+            << stats.spawns << std::setw(10) << stats.steals << std::setw(8) << stats.parks
+            << std::defaultfloat << std::setprecision(6) << '\n';
+}
+
+std::string milliseconds(double seconds)
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1) << seconds * 1e3 << " ms";
+  return out.str();
+}
+
+void print_header(const std::string& title)
+{
+  std::cout << '\n'
+            << title << ":\n"
+            << "  threads   time (ms)  speedup  efficiency      spawns    steals   parks\n";
+}
+
+void spawn_overhead(unsigned max_threads, size_t tasks)
+{
+  std::cout << "Spawn overhead:\n";
+  for (unsigned threads : max_threads > 1 ? std::vector<unsigned>{1, max_threads}
+                                           : std::vector<unsigned>{1})
+  {
+    Scheduler scheduler(threads);
+    double flat = time_seconds([&] {
+      scheduler.run([&] {
+        TaskGroup group;
+        for (size_t i = 0; i < tasks; ++i)
+        {
+          scheduler.spawn(group, [] {});
+        }
+        scheduler.wait(group);
+      });
+    });
+    uint64_t before = scheduler.stats().spawns;
+    double nested = time_seconds([&] { scheduler.run([&] { fib(scheduler, 25, 2); }); });
+    double spawned = static_cast<double>(scheduler.stats().spawns - before);
+    std::cout << "  " << threads << " thread(s): " << std::setprecision(1) << std::fixed
+              << flat / tasks * 1e9 << " ns per flat spawn+join, " << nested / spawned * 1e9
+              << " ns per nested spawn+join (fib(25), cutoff 2)" << std::defaultfloat
+              << std::setprecision(6) << '\n';
+  }
+}
+
+void fib_scaling(unsigned max_threads, int n)
+{
+  uint64_t expected = 0;
+  double serial = time_seconds([&] { expected = serial_fib(n); });
+  print_header("fib(" + std::to_string(n) + "), cutoff " + std::to_string(kFibCutoff) +
+               ", serial " + milliseconds(serial));
+  double baseline = 0;
+  for (unsigned threads : thread_counts(max_threads))
+  {
+    Scheduler scheduler(threads);
+    uint64_t result = 0;
+    double seconds = time_seconds([&] {
+      scheduler.run([&] { result = fib(scheduler, n, kFibCutoff); });
+    });
+    if (result != expected)
+    {
+      throw std::logic_error("fib mismatch");
+    }
+    baseline = threads == 1 ? seconds : baseline;
+    print_row(threads, seconds, baseline, scheduler);
+  }
+}
+
+void sort_scaling(unsigned max_threads, size_t count)
+{
+  std::vector<uint32_t> input(count);
+  std::mt19937 gen(42);
+  for (auto& value : input)
+  {
+    value = gen();
+  }
+  std::vector<uint32_t> expected = input;
+  double serial = time_seconds([&] { std::sort(expected.begin(), expected.end()); });
+  print_header("quicksort of " + std::to_string(count) + " uint32, std::sort " +
+               milliseconds(serial));
+  double baseline = 0;
+  for (unsigned threads : thread_counts(max_threads))
+  {
+    Scheduler scheduler(threads);
+    std::vector<uint32_t> data = input;
+    double seconds = time_seconds([&] {
+      scheduler.run([&] { quicksort(scheduler, data.data(), data.data() + data.size()); });
+    });
+    if (data != expected)
+    {
+      throw std::logic_error("quicksort mismatch");
+    }
+    baseline = threads == 1 ? seconds : baseline;
+    print_row(threads, seconds, baseline, scheduler);
+  }
+}
+
+// The cost of element i grows with i, so equal static chunks would leave the early workers idle.
+void for_scaling(unsigned max_threads, size_t count)
+{
+  std::vector<double> out(count);
+  auto body = [&](size_t i) {
+    double x = static_cast<double>(i);
+    size_t rounds = 1 + i * 64 / count;
+    for (size_t r = 0; r < rounds; ++r)
+    {
+      x = std::sqrt(x + 1.0);
+    }
+    out[i] = x;
+  };
+  print_header("parallel_for over " + std::to_string(count) + " elements of rising cost, " +
+               "adaptive grain");
+  double baseline = 0;
+  for (unsigned threads : thread_counts(max_threads))
+  {
+    Scheduler scheduler(threads);
+    double seconds = time_seconds([&] {
+      scheduler.run([&] { scheduler.parallel_for(0, count, body); });
+    });
+    baseline = threads == 1 ? seconds : baseline;
+    print_row(threads, seconds, baseline, scheduler);
+  }
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--threads N] [--spawns N] [--fib N] [--sort N] [--for N]\n"
+               "Scales each benchmark from 1 to N threads (default: hardware threads).\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t spawns = 1000000;
+  int fib_n = 36;
+  size_t sort_count = 20000000;
+  size_t for_count = 4000000;
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--threads")
+      {
+        max_threads = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+      }
+      else if (arg == "--spawns")
+      {
+        spawns = std::stoul(value);
+      }
+      else if (arg == "--fib")
+      {
+        fib_n = std::stoi(value);
+      }
+      else if (arg == "--sort")
+      {
+        sort_count = std::stoul(value);
+      }
+      else if (arg == "--for")
+      {
+        for_count = std::stoul(value);
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    spawn_overhead(max_threads, spawns);
+    fib_scaling(max_threads, fib_n);
+    sort_scaling(max_threads, sort_count);
+    for_scaling(max_threads, for_count);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,200 @@
+#include "scheduler.hpp"
+
+Scheduler::Scheduler(unsigned threads)
+{
+  if (threads == 0)
+  {
+    threads = 1;
+  }
+  for (unsigned i = 0; i < threads; ++i)
+  {
+    workers.push_back(std::make_unique<Worker>());
+    workers.back()->scheduler = this;
+    workers.back()->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+  }
+  for (unsigned i = 1; i < threads; ++i)
+  {
+    threads_.emplace_back([this, i] { worker_loop(*workers[i]); });
+  }
+}
+
+Scheduler::~Scheduler()
+{
+  {
+    std::lock_guard<std::mutex> guard(park_lock);
+    stopping.store(true, std::memory_order_relaxed);
+    wake_epoch.fetch_add(1, std::memory_order_relaxed);
+  }
+  park_cv.notify_all();
+  for (auto& thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+auto Scheduler::self() -> Worker&
+{
+  if (!current || current->scheduler != this)
+  {
+    throw std::logic_error("spawn, wait and parallel_for must run inside Scheduler::run");
+  }
+  return *current;
+}
+
+void Scheduler::push(Worker& worker, Task* task)
+{
+  worker.deque.push(task);
+  // Pairs with the fence in park(): either this sees the sleeper or the sleeper sees the task.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleepers.load(std::memory_order_relaxed) > 0)
+  {
+    wake_one();
+  }
+}
+
+auto Scheduler::find_task(Worker& worker) -> Task*
+{
+  Task* task = nullptr;
+  if (worker.deque.take(task))
+  {
+    return task;
+  }
+  size_t count = workers.size();
+  if (count == 1)
+  {
+    return nullptr;
+  }
+  // xorshift64 picks where the sweep over victims starts, so thieves spread out.
+  worker.rng ^= worker.rng << 13;
+  worker.rng ^= worker.rng >> 7;
+  worker.rng ^= worker.rng << 17;
+  size_t start = static_cast<size_t>(worker.rng % count);
+  for (size_t offset = 0; offset < count; ++offset)
+  {
+    Worker& victim = *workers[(start + offset) % count];
+    if (&victim != &worker && victim.deque.steal(task))
+    {
+      worker.steals.store(worker.steals.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void Scheduler::execute(Task* task)
+{
+  TaskGroup* group = task->group;
+  try
+  {
+    task->execute();
+  }
+  catch (...)
+  {
+    if (!group->failed.exchange(true, std::memory_order_relaxed))
+    {
+      group->failure = std::current_exception();
+    }
+  }
+  delete task;
+  // Last touch of the group: the waiter may return and destroy it as soon as this lands.
+  group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void Scheduler::drain(TaskGroup& group)
+{
+  Worker& worker = self();
+  while (group.pending.load(std::memory_order_acquire) != 0)
+  {
+    if (Task* task = find_task(worker))
+    {
+      execute(task);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void Scheduler::wait(TaskGroup& group)
+{
+  drain(group);
+  if (group.failed.load(std::memory_order_relaxed))
+  {
+    group.failed.store(false, std::memory_order_relaxed);
+    std::rethrow_exception(std::exchange(group.failure, nullptr));
+  }
+}
+
+bool Scheduler::work_available() const
+{
+  for (const auto& worker : workers)
+  {
+    if (worker->deque.size_hint() > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Scheduler::park(Worker& worker)
+{
+  uint64_t seen = wake_epoch.load(std::memory_order_acquire);
+  sleepers.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!work_available() && !stopping.load(std::memory_order_relaxed))
+  {
+    worker.parks.store(worker.parks.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(park_lock);
+    park_cv.wait(lock, [&] { return wake_epoch.load(std::memory_order_relaxed) != seen; });
+  }
+  sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Scheduler::wake_one()
+{
+  {
+    std::lock_guard<std::mutex> guard(park_lock);
+    wake_epoch.fetch_add(1, std::memory_order_relaxed);
+  }
+  park_cv.notify_one();
+}
+
+void Scheduler::worker_loop(Worker& worker)
+{
+  current = &worker;
+  unsigned idle = 0;
+  while (!stopping.load(std::memory_order_relaxed))
+  {
+    if (Task* task = find_task(worker))
+    {
+      execute(task);
+      idle = 0;
+    }
+    else if (++idle < kSpinRounds)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      park(worker);
+      idle = 0;
+    }
+  }
+  current = nullptr;
+}
+
+SchedulerStats Scheduler::stats() const
+{
+  SchedulerStats result;
+  for (const auto& worker : workers)
+  {
+    result.spawns += worker->spawns.load(std::memory_order_relaxed);
+    result.steals += worker->steals.load(std::memory_order_relaxed);
+    result.parks += worker->parks.load(std::memory_order_relaxed);
+  }
+  return result;
+}
@@ -0,0 +1,227 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "chase_lev.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Join counter for a batch of spawned tasks. Lives on the spawning frame, which must wait on it
+// before returning; the first exception thrown by any of its tasks is rethrown by that wait.
+class TaskGroup
+{
+private:
+  friend class Scheduler;
+
+  std::atomic<size_t> pending{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr failure;
+
+public:
+  TaskGroup() = default;
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+};
+
+struct SchedulerStats
+{
+  uint64_t spawns = 0;
+  uint64_t steals = 0;
+  uint64_t parks = 0; // times a worker went to sleep on the condition variable
+};
+
+// Fork-join scheduler over per-worker Chase-Lev deques. A worker runs its own deque newest first
+// (depth-first, cache-warm) and, when it runs dry, steals the oldest task of a random victim,
+// which for recursive splits is the biggest piece left. Waiting on a TaskGroup executes other
+// tasks instead of blocking. Workers that find nothing for a while park on a condition variable
+// and are woken by the next spawn.
+//
+// The thread calling run() becomes worker 0 for the duration, so a Scheduler of N threads starts
+// N - 1 background workers and only one run() may be active at a time. spawn, wait and
+// parallel_for may only be called from tasks running under run().
+class Scheduler
+{
+private:
+  struct Task
+  {
+    virtual ~Task() = default;
+    virtual void execute() = 0;
+    TaskGroup* group = nullptr;
+  };
+
+  template <typename F>
+  struct FunctionTask final : Task
+  {
+    explicit FunctionTask(F&& fn) : fn(std::move(fn))
+    {
+    }
+    void execute() override
+    {
+      fn();
+    }
+    F fn;
+  };
+
+  struct alignas(64) Worker
+  {
+    ChaseLevDeque<Task*> deque;
+    Scheduler* scheduler = nullptr;
+    uint64_t rng = 0;
+    std::atomic<uint64_t> spawns{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> parks{0};
+  };
+
+  static constexpr unsigned kSpinRounds = 64;
+  static constexpr size_t kChunksPerWorker = 8;
+
+  inline static thread_local Worker* current = nullptr;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads_;
+  std::mutex run_lock;
+
+  std::mutex park_lock;
+  std::condition_variable park_cv;
+  std::atomic<unsigned> sleepers{0};
+  std::atomic<uint64_t> wake_epoch{0};
+  std::atomic<bool> stopping{false};
+
+  Worker& self();
+  void push(Worker& worker, Task* task);
+  Task* find_task(Worker& worker);
+  void execute(Task* task);
+  void drain(TaskGroup& group);
+  bool work_available() const;
+  void park(Worker& worker);
+  void wake_one();
+  void worker_loop(Worker& worker);
+
+  template <typename F>
+  void split_range(size_t begin, size_t end, size_t grain, const F& body);
+
+public:
+  explicit Scheduler(unsigned threads = std::thread::hardware_concurrency());
+  ~Scheduler();
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  // Runs root on the calling thread, with the pool helping on whatever it spawns, and returns
+  // once root has finished. Exceptions from root or any task it joined propagate.
+  template <typename F>
+  void run(F&& root);
+
+  template <typename F>
+  void spawn(TaskGroup& group, F&& fn);
+
+  // Runs other tasks until every task spawned into group has finished.
+  void wait(TaskGroup& group);
+
+  // Calls body(i) for every i in [begin, end). With grain 0 the grain is picked from the range
+  // and the worker count; either way ranges are split lazily, only while the splitting worker's
+  // own deque is empty, so a loop that nobody steals from runs as one sequential pass.
+  template <typename F>
+  void parallel_for(size_t begin, size_t end, F&& body, size_t grain = 0);
+
+  unsigned threads() const
+  {
+    return static_cast<unsigned>(workers.size());
+  }
+  SchedulerStats stats() const;
+};
+
+template <typename F>
+void Scheduler::run(F&& root)
+{
+  std::lock_guard<std::mutex> guard(run_lock);
+  if (current)
+  {
+    throw std::logic_error("Scheduler::run called from inside a task");
+  }
+  current = workers[0].get();
+  TaskGroup group;
+  try
+  {
+    spawn(group, std::forward<F>(root));
+    wait(group);
+  }
+  catch (...)
+  {
+    current = nullptr;
+    throw;
+  }
+  current = nullptr;
+}
+
+template <typename F>
+void Scheduler::spawn(TaskGroup& group, F&& fn)
+{
+  Worker& worker = self();
+  auto* task = new FunctionTask<std::decay_t<F>>(std::decay_t<F>(std::forward<F>(fn)));
+  task->group = &group;
+  group.pending.fetch_add(1, std::memory_order_relaxed);
+  worker.spawns.store(worker.spawns.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+  push(worker, task);
+}
+
+template <typename F>
+void Scheduler::split_range(size_t begin, size_t end, size_t grain, const F& body)
+{
+  TaskGroup group;
+  Worker& worker = self();
+  try
+  {
+    while (begin < end)
+    {
+      if (end - begin > grain && worker.deque.size_hint() == 0)
+      {
+        size_t middle = begin + (end - begin) / 2;
+        spawn(group, [this, middle, end, grain, &body] { split_range(middle, end, grain, body); });
+        end = middle;
+        continue;
+      }
+      size_t stop = std::min(end, begin + grain);
+      for (size_t i = begin; i < stop; ++i)
+      {
+        body(i);
+      }
+      begin = stop;
+    }
+  }
+  catch (...)
+  {
+    // The spawned halves still point at group and body.
+    drain(group);
+    throw;
+  }
+  wait(group);
+}
+
+template <typename F>
+void Scheduler::parallel_for(size_t begin, size_t end, F&& body, size_t grain)
+{
+  if (begin >= end)
+  {
+    return;
+  }
+  if (grain == 0)
+  {
+    grain = std::max<size_t>(1, (end - begin) / (kChunksPerWorker * workers.size()));
+  }
+  split_range(begin, end, grain, body);
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include "mlfq.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void print_class(const char* name, const ClassStats& stats)
+{
+  std::cout << "  " << std::left << std::setw(10) << name << std::right << std::setw(9)
+            << stats.jobs << std::fixed << std::setprecision(1) << std::setw(12)
+            << stats.mean_turnaround << std::setw(11) << stats.p99_turnaround << std::setw(12)
+            << stats.mean_response << std::setw(11) << stats.p99_response << std::setprecision(2)
+            << std::setw(11) << stats.mean_slowdown << std::setprecision(3) << std::setw(10)
+            << stats.fairness << std::defaultfloat << std::setprecision(6) << '\n';
+}
+
+void report(const MlfqConfig& config, const std::vector<JobSpec>& jobs)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  MlfqStats stats = simulate(config, jobs);
+  auto end = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  std::cout << config.levels << " levels, quanta";
+  for (uint32_t level = 0; level < config.levels; ++level)
+  {
+    std::cout << ' ' << config.quantum(level);
+  }
+  std::cout << ", allotment " << config.allotment_slices << " slice(s), boost every "
+            << (config.boost_interval ? std::to_string(config.boost_interval) : "never")
+            << ":\n"
+            << "  class          jobs  turnaround    p99 turn    response    p99 resp   slowdown"
+               "  fairness\n";
+  print_class("all", stats.all);
+  print_class("io-bound", stats.io_bound);
+  print_class("cpu-bound", stats.cpu_bound);
+  std::cout << std::fixed << std::setprecision(2) << "  throughput " << stats.throughput()
+            << " jobs/1000 ticks, utilisation " << stats.utilisation() * 100 << "%, "
+            << stats.dispatches << " dispatches, " << stats.preemptions << " preemptions, "
+            << stats.demotions << " demotions, " << stats.boosts << " boosts\n"
+            << "  simulated " << jobs.size() << " jobs in " << std::setprecision(3) << seconds
+            << " s (" << std::setprecision(2) << jobs.size() / seconds / 1e6 << " M jobs/s)\n"
+            << std::defaultfloat << std::setprecision(6);
+}
+
+// Levels against boost interval, one line per configuration.
+void sweep(MlfqConfig config, const std::vector<JobSpec>& jobs)
+{
+  std::cout << "levels  boost  turnaround  p99 resp  io resp  io slowdown  cpu slowdown"
+               "  fairness  seconds\n";
+  for (uint32_t levels : {1u, 2u, 3u, 4u, 6u, 8u})
+  {
+    for (uint64_t boost : {uint64_t{0}, uint64_t{1000}, uint64_t{10000}, uint64_t{100000}})
+    {
+      config.levels = levels;
+      config.boost_interval = boost;
+      auto start = std::chrono::high_resolution_clock::now();
+      MlfqStats stats = simulate(config, jobs);
+      auto end = std::chrono::high_resolution_clock::now();
+      std::cout << std::setw(6) << levels << std::setw(7)
+                << (boost ? std::to_string(boost) : "off") << std::fixed << std::setprecision(1)
+                << std::setw(12) << stats.all.mean_turnaround << std::setw(10)
+                << stats.all.p99_response << std::setw(9) << stats.io_bound.mean_response
+                << std::setprecision(2) << std::setw(13) << stats.io_bound.mean_slowdown
+                << std::setw(14) << stats.cpu_bound.mean_slowdown << std::setprecision(3)
+                << std::setw(10) << stats.all.fairness << std::setprecision(2) << std::setw(9)
+                << std::chrono::duration<double>(end - start).count() << std::defaultfloat
+                << std::setprecision(6) << '\n';
+    }
+  }
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0
+            << " [--levels N] [--quantum TICKS] [--growth X] [--allotment SLICES]\n"
+               "       [--boost TICKS|0] [--switch TICKS] [--jobs N] [--io-percent P]"
+               " [--load L] [--seed S] [--sweep 0|1]\n"
+               "Simulates one configuration, or with --sweep 1 a grid of levels and boost"
+               " intervals, on the same generated workload.\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  MlfqConfig config;
+  WorkloadConfig workload;
+  bool grid = false;
+
+  // std::stoul and friends throw on a malformed number; report it as a usage error.
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (i + 1 >= argc)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      std::string value = argv[++i];
+      if (arg == "--levels")
+      {
+        config.levels = std::stoul(value);
+      }
+      else if (arg == "--quantum")
+      {
+        config.base_quantum = std::stoul(value);
+      }
+      else if (arg == "--growth")
+      {
+        config.quantum_growth = std::stoul(value);
+      }
+      else if (arg == "--allotment")
+      {
+        config.allotment_slices = std::stoul(value);
+      }
+      else if (arg == "--boost")
+      {
+        config.boost_interval = std::stoull(value);
+      }
+      else if (arg == "--switch")
+      {
+        config.switch_ticks = std::stoul(value);
+      }
+      else if (arg == "--jobs")
+      {
+        workload.jobs = std::stoull(value);
+      }
+      else if (arg == "--io-percent")
+      {
+        workload.io_percent = std::stoul(value);
+      }
+      else if (arg == "--load")
+      {
+        workload.load = std::stod(value);
+      }
+      else if (arg == "--seed")
+      {
+        workload.seed = std::stoull(value);
+      }
+      else if (arg == "--sweep")
+      {
+        grid = value != "0";
+      }
+      else
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+  }
+  catch (const std::logic_error&)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try
+  {
+    std::vector<JobSpec> jobs = generate_workload(workload);
+    std::cout << jobs.size() << " jobs, " << workload.io_percent << "% I/O-bound, offered load "
+              << workload.load << "\n\n";
+    if (grid)
+    {
+      sweep(config, jobs);
+    }
+    else
+    {
+      report(config, jobs);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,394 @@
+#include "mlfq.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+constexpr uint32_t kMaxLevels = 64;
+
+struct JobState
+{
+  uint64_t first_run = 0;
+  uint32_t remaining = 0;  // CPU ticks left in total
+  uint32_t burst_left = 0; // CPU ticks left before the next I/O
+  uint32_t used = 0;       // CPU ticks used against the current level's allotment
+  uint32_t epoch = 0;      // boost epoch the level and allotment belong to
+  uint32_t next = kNone;   // ready-queue link
+  uint8_t level = 0;
+  bool started = false;
+};
+
+// One intrusive FIFO per level plus a bitmap of the non-empty ones.
+class ReadyQueues
+{
+private:
+  std::vector<uint32_t> head;
+  std::vector<uint32_t> tail;
+  uint64_t mask = 0;
+
+public:
+  explicit ReadyQueues(uint32_t levels) : head(levels, kNone), tail(levels, kNone)
+  {
+  }
+
+  bool empty() const
+  {
+    return mask == 0;
+  }
+  uint32_t top_level() const
+  {
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+  }
+
+  void push(std::vector<JobState>& jobs, uint32_t level, uint32_t job)
+  {
+    jobs[job].next = kNone;
+    if (tail[level] == kNone)
+    {
+      head[level] = job;
+    }
+    else
+    {
+      jobs[tail[level]].next = job;
+    }
+    tail[level] = job;
+    mask |= uint64_t{1} << level;
+  }
+
+  // Pops the oldest job of the highest non-empty level, which is returned in `level`.
+  uint32_t pop(std::vector<JobState>& jobs, uint32_t& level)
+  {
+    level = top_level();
+    uint32_t job = head[level];
+    head[level] = jobs[job].next;
+    if (head[level] == kNone)
+    {
+      tail[level] = kNone;
+      mask &= ~(uint64_t{1} << level);
+    }
+    return job;
+  }
+
+  // Appends every lower level to the top one, oldest level first.
+  void splice_to_top(std::vector<JobState>& jobs)
+  {
+    for (size_t level = 1; level < head.size(); ++level)
+    {
+      if (head[level] == kNone)
+      {
+        continue;
+      }
+      if (tail[0] == kNone)
+      {
+        head[0] = head[level];
+      }
+      else
+      {
+        jobs[tail[0]].next = head[level];
+      }
+      tail[0] = tail[level];
+      head[level] = kNone;
+      tail[level] = kNone;
+    }
+    mask = mask ? 1 : 0;
+  }
+};
+
+struct Samples
+{
+  std::vector<uint64_t> turnaround;
+  std::vector<uint64_t> response;
+  std::vector<double> slowdown;
+};
+
+double percentile(std::vector<uint64_t>& values, double fraction)
+{
+  if (values.empty())
+  {
+    return 0.0;
+  }
+  size_t rank = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+  std::nth_element(values.begin(), values.begin() + rank, values.end());
+  return static_cast<double>(values[rank]);
+}
+
+ClassStats summarise(Samples& samples)
+{
+  ClassStats stats;
+  stats.jobs = samples.turnaround.size();
+  if (stats.jobs == 0)
+  {
+    return stats;
+  }
+  double turnaround = 0;
+  double response = 0;
+  double slowdown = 0;
+  double slowdown_squares = 0;
+  for (size_t i = 0; i < stats.jobs; ++i)
+  {
+    turnaround += samples.turnaround[i];
+    response += samples.response[i];
+    slowdown += samples.slowdown[i];
+    slowdown_squares += samples.slowdown[i] * samples.slowdown[i];
+  }
+  stats.mean_turnaround = turnaround / stats.jobs;
+  stats.mean_response = response / stats.jobs;
+  stats.mean_slowdown = slowdown / stats.jobs;
+  stats.fairness = slowdown * slowdown / (stats.jobs * slowdown_squares);
+  stats.p99_turnaround = percentile(samples.turnaround, 0.99);
+  stats.p99_response = percentile(samples.response, 0.99);
+  return stats;
+}
+
+void append(Samples& into, const Samples& from)
+{
+  into.turnaround.insert(into.turnaround.end(), from.turnaround.begin(), from.turnaround.end());
+  into.response.insert(into.response.end(), from.response.begin(), from.response.end());
+  into.slowdown.insert(into.slowdown.end(), from.slowdown.begin(), from.slowdown.end());
+}
+} // namespace
+
+uint32_t MlfqConfig::quantum(uint32_t level) const
+{
+  uint64_t slice = base_quantum;
+  for (uint32_t i = 0; i < level && slice < std::numeric_limits<uint32_t>::max(); ++i)
+  {
+    slice *= quantum_growth;
+  }
+  return static_cast<uint32_t>(std::min<uint64_t>(slice, std::numeric_limits<uint32_t>::max()));
+}
+
+std::vector<JobSpec> generate_workload(const WorkloadConfig& config)
+{
+  if (config.io_percent > 100 || config.load <= 0 || config.cpu_burst == 0 || config.io_burst == 0)
+  {
+    throw std::invalid_argument("io_percent must be 0-100, load and bursts positive");
+  }
+  std::mt19937_64 gen(config.seed);
+  double io_share = config.io_percent / 100.0;
+  double mean_service = io_share * config.io_service + (1 - io_share) * config.cpu_service;
+  std::exponential_distribution<double> gap(config.load / mean_service);
+  std::exponential_distribution<double> cpu_service(1.0 / config.cpu_service);
+  std::exponential_distribution<double> io_service(1.0 / config.io_service);
+  std::uniform_int_distribution<uint32_t> io_wait(config.io_wait / 2,
+                                                  config.io_wait + config.io_wait / 2);
+  std::bernoulli_distribution pick_io(io_share);
+
+  std::vector<JobSpec> jobs(config.jobs);
+  double clock = 0;
+  for (auto& job : jobs)
+  {
+    clock += gap(gen);
+    job.arrival = static_cast<uint64_t>(clock);
+    job.io_bound = pick_io(gen);
+    double service = job.io_bound ? io_service(gen) : cpu_service(gen);
+    job.service = static_cast<uint32_t>(std::max(1.0, std::round(service)));
+    job.burst = job.io_bound ? config.io_burst : config.cpu_burst;
+    job.io = io_wait(gen);
+  }
+  return jobs;
+}
+
+MlfqStats simulate(const MlfqConfig& config, const std::vector<JobSpec>& jobs)
+{
+  if (config.levels == 0 || config.levels > kMaxLevels)
+  {
+    throw std::invalid_argument("levels must be between 1 and 64");
+  }
+  if (config.base_quantum == 0 || config.quantum_growth == 0 || config.allotment_slices == 0)
+  {
+    throw std::invalid_argument("quantum, growth and allotment must be positive");
+  }
+
+  const size_t count = jobs.size();
+  std::vector<JobState> state(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (jobs[i].service == 0 || jobs[i].burst == 0)
+    {
+      throw std::invalid_argument("every job needs positive service and burst");
+    }
+    if (i > 0 && jobs[i].arrival < jobs[i - 1].arrival)
+    {
+      throw std::invalid_argument("jobs must be sorted by arrival");
+    }
+    state[i].remaining = jobs[i].service;
+    state[i].burst_left = std::min(jobs[i].burst, jobs[i].service);
+  }
+
+  ReadyQueues ready(config.levels);
+  using Wakeup = std::pair<uint64_t, uint32_t>;
+  std::priority_queue<Wakeup, std::vector<Wakeup>, std::greater<Wakeup>> blocked;
+  Samples io_samples;
+  Samples cpu_samples;
+  MlfqStats stats;
+
+  uint32_t epoch = 0;
+  uint64_t now = 0;
+  uint64_t next_boost = config.boost_interval ? config.boost_interval : kNever;
+  size_t next_arrival = 0;
+  size_t done = 0;
+  uint32_t running = kNone;
+  uint64_t run_start = 0;
+  uint64_t run_end = 0;
+
+  // Rule 4: the allotment is charged across slices and I/O alike.
+  auto charge_level = [&](JobState& job) {
+    if (job.used < config.allotment(job.level))
+    {
+      return;
+    }
+    job.used = 0;
+    if (job.level + 1u < config.levels)
+    {
+      ++job.level;
+      ++stats.demotions;
+    }
+  };
+  auto make_ready = [&](uint32_t id) {
+    JobState& job = state[id];
+    if (job.epoch != epoch)
+    {
+      job.level = 0;
+      job.used = 0;
+      job.epoch = epoch;
+    }
+    ready.push(state, job.level, id);
+  };
+
+  while (done < count)
+  {
+    bool occupied = running != kNone || !ready.empty() || !blocked.empty();
+    uint64_t t = running != kNone ? run_end : kNever;
+    if (next_arrival < count)
+    {
+      t = std::min(t, jobs[next_arrival].arrival);
+    }
+    if (!blocked.empty())
+    {
+      t = std::min(t, blocked.top().first);
+    }
+    if (occupied)
+    {
+      t = std::min(t, next_boost);
+    }
+    else if (next_boost != kNever && next_boost <= t)
+    {
+      // Nothing to boost across an idle gap; skip to the first boost after it.
+      next_boost += ((t - next_boost) / config.boost_interval + 1) * config.boost_interval;
+    }
+
+    if (running != kNone && t > run_start)
+    {
+      uint32_t elapsed = static_cast<uint32_t>(t - run_start);
+      JobState& job = state[running];
+      job.burst_left -= elapsed;
+      job.remaining -= elapsed;
+      job.used += elapsed;
+      stats.busy_ticks += elapsed;
+      run_start = t;
+    }
+    now = t;
+
+    if (running != kNone && now == run_end)
+    {
+      JobState& job = state[running];
+      if (job.remaining == 0)
+      {
+        const JobSpec& spec = jobs[running];
+        Samples& samples = spec.io_bound ? io_samples : cpu_samples;
+        uint64_t ios = (spec.service + spec.burst - 1) / spec.burst - 1;
+        samples.turnaround.push_back(now - spec.arrival);
+        samples.response.push_back(job.first_run - spec.arrival);
+        samples.slowdown.push_back(static_cast<double>(now - spec.arrival) /
+                                   (spec.service + ios * spec.io));
+        ++done;
+      }
+      else if (job.burst_left == 0)
+      {
+        charge_level(job);
+        job.burst_left = std::min(jobs[running].burst, job.remaining);
+        blocked.push({now + jobs[running].io, running});
+      }
+      else
+      {
+        charge_level(job);
+        ready.push(state, job.level, running);
+      }
+      running = kNone;
+    }
+
+    while (next_arrival < count && jobs[next_arrival].arrival <= now)
+    {
+      state[next_arrival].epoch = epoch;
+      ready.push(state, 0, static_cast<uint32_t>(next_arrival));
+      ++next_arrival;
+    }
+    while (!blocked.empty() && blocked.top().first <= now)
+    {
+      make_ready(blocked.top().second);
+      blocked.pop();
+    }
+    if (now >= next_boost)
+    {
+      ++epoch;
+      ++stats.boosts;
+      ready.splice_to_top(state);
+      if (running != kNone)
+      {
+        state[running].level = 0;
+        state[running].used = 0;
+        state[running].epoch = epoch;
+      }
+      next_boost += config.boost_interval;
+    }
+
+    if (running != kNone && !ready.empty() && ready.top_level() < state[running].level)
+    {
+      ready.push(state, state[running].level, running);
+      running = kNone;
+      ++stats.preemptions;
+    }
+
+    if (running == kNone && !ready.empty())
+    {
+      uint32_t level;
+      running = ready.pop(state, level);
+      JobState& job = state[running];
+      job.level = static_cast<uint8_t>(level);
+      if (job.epoch != epoch)
+      {
+        job.used = 0;
+        job.epoch = epoch;
+      }
+      if (!job.started)
+      {
+        job.started = true;
+        job.first_run = now + config.switch_ticks;
+      }
+      uint32_t slice = std::min({config.quantum(level), config.allotment(level) - job.used,
+                                 job.burst_left});
+      run_start = now + config.switch_ticks;
+      run_end = run_start + slice;
+      ++stats.dispatches;
+    }
+  }
+
+  stats.makespan = now;
+  Samples all_samples;
+  append(all_samples, io_samples);
+  append(all_samples, cpu_samples);
+  stats.all = summarise(all_samples);
+  stats.io_bound = summarise(io_samples);
+  stats.cpu_bound = summarise(cpu_samples);
+  return stats;
+}
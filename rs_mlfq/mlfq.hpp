@@ -0,0 +1,99 @@
+#ifndef MLFQ_HPP
+#define MLFQ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multi-level feedback queue on one CPU, after the rules in OSTEP chapter 8:
+// 1. a ready job at a higher level always runs before a lower one (arrivals preempt)
+// 2. jobs at the same level round-robin with that level's time slice
+// 3. new jobs enter at the top level
+// 4. a job that has used its allotment at a level moves down one, however it gave up the CPU
+// 5. every boost_interval ticks all jobs move back to the top level
+// Time is in integer ticks; context switches are free unless switch_ticks says otherwise.
+struct MlfqConfig
+{
+  uint32_t levels = 3;
+  uint32_t base_quantum = 10;     // slice at the top level
+  uint32_t quantum_growth = 2;    // each level's slice is this times the one above
+  uint32_t allotment_slices = 1;  // slices a job may use at one level before it is demoted
+  uint64_t boost_interval = 1000; // 0 disables priority boosts
+  uint32_t switch_ticks = 0;
+
+  uint32_t quantum(uint32_t level) const;
+  uint32_t allotment(uint32_t level) const
+  {
+    return quantum(level) * allotment_slices;
+  }
+};
+
+// A job alternates CPU bursts of `burst` ticks (the last one possibly shorter) with I/O waits of
+// `io` ticks until it has used `service` ticks of CPU. Bursts are not stored per job, which keeps
+// million-job workloads at a few tens of bytes per job.
+struct JobSpec
+{
+  uint64_t arrival = 0;
+  uint32_t service = 0;
+  uint32_t burst = 0;
+  uint32_t io = 0;
+  bool io_bound = false;
+};
+
+struct WorkloadConfig
+{
+  size_t jobs = 1000000;
+  uint32_t io_percent = 50;   // share of I/O-bound jobs
+  double load = 0.9;          // offered CPU utilisation, sets the Poisson arrival rate
+  uint32_t cpu_service = 400; // mean CPU demand of a CPU-bound job (exponential)
+  uint32_t cpu_burst = 200;
+  uint32_t io_service = 40;   // mean CPU demand of an I/O-bound job (exponential)
+  uint32_t io_burst = 4;
+  uint32_t io_wait = 50;      // ticks per I/O, uniform in [io_wait / 2, 3 * io_wait / 2]
+  uint64_t seed = 42;
+};
+
+// Jobs sorted by arrival.
+std::vector<JobSpec> generate_workload(const WorkloadConfig& config);
+
+struct ClassStats
+{
+  size_t jobs = 0;
+  double mean_turnaround = 0;
+  double p99_turnaround = 0;
+  double mean_response = 0; // arrival to first dispatch
+  double p99_response = 0;
+  double mean_slowdown = 0; // turnaround / (service + I/O), 1 is the best possible
+  double fairness = 0;      // Jain's index over slowdowns: 1 when every job is slowed equally
+};
+
+struct MlfqStats
+{
+  uint64_t makespan = 0;
+  uint64_t busy_ticks = 0;
+  uint64_t dispatches = 0;
+  uint64_t preemptions = 0;
+  uint64_t demotions = 0;
+  uint64_t boosts = 0;
+  ClassStats all;
+  ClassStats io_bound;
+  ClassStats cpu_bound;
+
+  double throughput() const // jobs per 1000 ticks
+  {
+    return makespan ? all.jobs * 1000.0 / makespan : 0.0;
+  }
+  double utilisation() const
+  {
+    return makespan ? static_cast<double>(busy_ticks) / makespan : 0.0;
+  }
+};
+
+// Discrete-event simulation: time jumps straight to the next arrival, I/O completion, slice end
+// or boost. Ready queues are intrusive FIFO lists threaded through the job table with a bitmap
+// of non-empty levels, so enqueue, dequeue and pick-highest are O(1); a boost splices every
+// level onto the top one and lets jobs notice their new level lazily through a boost epoch.
+// Only the I/O completions need a heap.
+MlfqStats simulate(const MlfqConfig& config, const std::vector<JobSpec>& jobs);
+
+#endif